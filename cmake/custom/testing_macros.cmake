@@ -54,7 +54,7 @@ macro(add_integration_test)
 endmacro()
 
 macro(add_Catch_test)
-  set(oneValueArgs NAME COST)
+  set(oneValueArgs NAME COST NPROCS)
   set(multiValueArgs LABELS DEPENDS REFERENCE_FILES)
   cmake_parse_arguments(_Catch_test
     "${options}"
@@ -63,8 +63,13 @@ macro(add_Catch_test)
     ${ARGN}
     )
 
+  if(NOT _Catch_test_NPROCS)
+    set(_Catch_test_NPROCS 1)
+  endif()
+
+  set(_unit_launcher)
   if (ENABLE_MPI)
-      set(_unit_launcher ${MPIEXEC} ${MPIEXEC_NUMPROC_FLAG} 1)
+      set(_unit_launcher ${MPIEXEC} ${MPIEXEC_NUMPROC_FLAG} ${_Catch_test_NPROCS})
   endif()
 
   add_test(
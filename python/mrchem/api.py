@@ -58,11 +58,22 @@ def translate_input(user_dict):
         "scf_calculation": scf_dict,
         "rsp_calculations": rsp_dict,
         "geom_opt": user_dict['GeometryOptimizer'],
+        "hessian": write_hessian(user_dict),
         "constants": user_dict["Constants"],
     }
     return program_dict
 
 
+def write_hessian(user_dict):
+    hess_dict = {
+        "run": user_dict["Hessian"]["run"],
+        "step_size": user_dict["Hessian"]["step_size"],
+        "n_groups": user_dict["Hessian"]["n_groups"],
+        "file_phi_ref": user_dict["SCF"]["path_orbitals"] + "/phi_hessian_ref",
+    }
+    return hess_dict
+
+
 def write_mpi(user_dict):
     mpi_dict = {
         "numerically_exact": user_dict["MPI"]["numerically_exact"],
@@ -161,6 +172,10 @@ def write_scf_calculation(user_dict, origin):
             "file_phi_a": path_orbitals + "/phi_a_scf",
             "file_phi_b": path_orbitals + "/phi_b_scf",
         }
+    if user_dict["SCF"]["write_operators"]:
+        scf_dict["write_operators"] = {
+            "file_operators": path_orbitals + "/fock_scf",
+        }
     if user_dict["SCF"]["run"]:
         scf_dict["scf_solver"] = write_scf_solver(user_dict, wf_dict)
 
@@ -93,6 +93,8 @@ def write_scf_fock(user_dict, wf_dict, origin):
         fock_dict["coulomb_operator"] = {
             "poisson_prec": user_dict["Precisions"]["poisson_prec"],
             "shared_memory": user_dict["MPI"]["share_coulomb_potential"],
+            "distributed": user_dict["MPI"]["distribute_coulomb_potential"],
+            "refresh_interval": user_dict["SCF"]["coulomb_refresh"],
         }
 
     # Exchange
@@ -148,6 +150,7 @@ def _reaction_operator_handler(user_dict, rsp=False):
         "kain": user_dict["PCM"]["SCRF"]["kain"],
         "max_iter": user_dict["PCM"]["SCRF"]["max_iter"],
         "dynamic_thrs": user_dict["PCM"]["SCRF"]["dynamic_thrs"],
+        "newton": user_dict["PCM"]["SCRF"]["newton"],
         # if doing a response calculation, then density_type is set to 1 (electronic only)
         "density_type": 1 if rsp else density_type,
         "epsilon_in": user_dict["PCM"]["Solvent"]["Permittivity"]["epsilon_in"],
@@ -235,6 +238,7 @@ def write_scf_guess(user_dict, wf_dict):
         "environment": wf_dict["environment_name"],
         "external_field": wf_dict["external_name"],
         "screen": scf_dict["guess_screen"],
+        "fragments": scf_dict["guess_fragments"],
         "localize": scf_dict["localize"],
         "rotate": scf_dict["guess_rotate"],
         "restricted": user_dict["WaveFunction"]["restricted"],
@@ -272,6 +276,7 @@ def write_scf_solver(user_dict, wf_dict):
         "max_iter": scf_dict["max_iter"],
         "rotation": scf_dict["rotation"],
         "localize": scf_dict["localize"],
+        "localize_method": scf_dict["localize_method"].lower(),
         "file_chk": scf_dict["path_checkpoint"] + "/phi_scf",
         "checkpoint": scf_dict["write_checkpoint"],
         "start_prec": start_prec,
@@ -357,6 +362,10 @@ def write_rsp_calc(omega, user_dict, origin):
         "localize": rsp_dict["localize"],
         "fock_operator": write_scf_fock(user_dict, wf_dict, origin),
     }
+    if rsp_dict["read_operators"]:
+        rsp_calc["unperturbed"]["read_operators"] = {
+            "file_operators": f"{user_dict['SCF']['path_orbitals']}/fock_scf",
+        }
 
     guess_str = rsp_dict["guess_type"].lower()
     user_guess_type = guess_str.split("_")[0]
@@ -436,6 +445,7 @@ def write_rsp_fock(user_dict, wf_dict):
         fock_dict["coulomb_operator"] = {
             "poisson_prec": user_dict["Precisions"]["poisson_prec"],
             "shared_memory": user_dict["MPI"]["share_coulomb_potential"],
+            "distributed": user_dict["MPI"]["distribute_coulomb_potential"],
         }
 
     # Exchange
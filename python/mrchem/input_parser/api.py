@@ -222,6 +222,9 @@ def stencil() -> JSONDict:
                                         {   'default': False,
                                             'name': 'share_coulomb_potential',
                                             'type': 'bool'},
+                                        {   'default': False,
+                                            'name': 'distribute_coulomb_potential',
+                                            'type': 'bool'},
                                         {   'default': False,
                                             'name': 'share_xc_potential',
                                             'type': 'bool'},
@@ -372,7 +375,8 @@ def stencil() -> JSONDict:
                                         {   'default': False,
                                             'name': 'hirshfeld_charges',
                                             'type': 'bool'},
-                                        {   'default': "user['GeometryOptimizer']['run']",
+                                        {   'default': "user['GeometryOptimizer']['run'] "
+                                                       "or user['Hessian']['run']",
                                             'name': 'geometric_derivative',
                                             'type': 'bool'}],
                         'name': 'Properties'},
@@ -497,6 +501,15 @@ def stencil() -> JSONDict:
                                         {   'default': False,
                                             'name': 'localize',
                                             'type': 'bool'},
+                                        {   'default': 'newton',
+                                            'name': 'localize_method',
+                                            'predicates': [   'value.lower() in '
+                                                              "['newton', "
+                                                              "'jacobi']"],
+                                            'type': 'str'},
+                                        {   'default': 0,
+                                            'name': 'coulomb_refresh',
+                                            'type': 'int'},
                                         {   'default': -1.0,
                                             'name': 'energy_thrs',
                                             'type': 'float'},
@@ -508,6 +521,9 @@ def stencil() -> JSONDict:
                                         {   'default': 12.0,
                                             'name': 'guess_screen',
                                             'type': 'float'},
+                                        {   'default': False,
+                                            'name': 'guess_fragments',
+                                            'type': 'bool'},
                                         {   'default': -1.0,
                                             'name': 'start_prec',
                                             'type': 'float'},
@@ -550,6 +566,9 @@ def stencil() -> JSONDict:
                                         {   'default': False,
                                             'name': 'write_orbitals_txt',
                                             'type': 'bool'},
+                                        {   'default': False,
+                                            'name': 'write_operators',
+                                            'type': 'bool'},
                                         {   'default': '10 * '
                                                        "user['world_prec']",
                                             'name': 'orbital_thrs',
@@ -602,6 +621,9 @@ def stencil() -> JSONDict:
                                             'name': 'path_orbitals',
                                             'predicates': ["value[-1] != '/'"],
                                             'type': 'str'},
+                                        {   'default': False,
+                                            'name': 'read_operators',
+                                            'type': 'bool'},
                                         {   'default': '10 * '
                                                        "user['world_prec']",
                                             'name': 'orbital_thrs',
@@ -627,7 +649,10 @@ def stencil() -> JSONDict:
                                                                 'type': 'str'},
                                                             {   'default': "user['SCF']['kain']",
                                                                 'name': 'kain',
-                                                                'type': 'int'}],
+                                                                'type': 'int'},
+                                                            {   'default': False,
+                                                                'name': 'newton',
+                                                                'type': 'bool'}],
                                             'name': 'SCRF'},
                                         {   'name': 'Solvent',
                                             'sections': [   {   'keywords': [   {   'default': 1.0,
@@ -711,6 +736,18 @@ def stencil() -> JSONDict:
                                             'name': 'max_force_component',
                                             'type': 'float'}],
                         'name': 'GeometryOptimizer'},
+                    {   'keywords': [   {   'default': False,
+                                            'name': 'run',
+                                            'type': 'bool'},
+                                        {   'default': 0.005,
+                                            'name': 'step_size',
+                                            'predicates': ['value > 0.0'],
+                                            'type': 'float'},
+                                        {   'default': 1,
+                                            'name': 'n_groups',
+                                            'predicates': ['value > 0'],
+                                            'type': 'int'}],
+                        'name': 'Hessian'},
                     {   'keywords': [   {   'default': 78.9451185,
                                             'name': 'hartree2simagnetizability',
                                             'type': 'float'},
@@ -755,6 +792,9 @@ def stencil() -> JSONDict:
                                             'type': 'float'},
                                         {   'default': 18897261246.2577,
                                             'name': 'meter2bohr',
+                                            'type': 'float'},
+                                        {   'default': 1822.888486209,
+                                            'name': 'amu2au',
                                             'type': 'float'}],
                         'name': 'Constants'},
                     {   'name': 'Elements',
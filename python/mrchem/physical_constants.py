@@ -166,6 +166,13 @@ class MRChemPhysConstants:
         docstring = f"| conversion factor from meter to Bohr radius (unit: {unit}). Affected code: Value of the Debye-Huckel screening parameter in the Poisson-Boltzmann equation."
         self.add_constant(name, unit, value, docstring)
 
+        # atomic mass unit to electron mass
+        name = "amu2au"
+        unit = "au"
+        value = self.qce.amu2au
+        docstring = f"| Conversion factor for masses from atomic mass units to electron masses (unit: {unit}). Affected code: Mass-weighted Hessian in the vibrational analysis."
+        self.add_constant(name, unit, value, docstring)
+
         # Set our constants to instance attributes for easy access
         for name, _, value, _ in self.data:
             self.__setattr__(name.lower(), float(value))
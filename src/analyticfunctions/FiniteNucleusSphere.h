@@ -35,22 +35,6 @@ class FiniteNucleusSphere : public NuclearFunction {
 public:
     FiniteNucleusSphere() = default;
 
-    double evalf(const mrcpp::Coord<3> &r) const override {
-        double result = 0.0;
-        for (int i = 0; i < this->nuclei.size(); i++) {
-            const auto &R = this->nuclei[i].getCoord();
-            auto R1 = math_utils::calc_distance(r, R);
-            auto Z = this->nuclei[i].getCharge();
-            auto R0 = this->param2[i];
-            if (R1 <= R0) {
-                result += -(Z / (2.0*R0)) * (3.0 - (R1*R1)/(R0*R0));
-            } else { 
-                result += -(Z / R1);
-            }
-        }
-        return result;
-    }
-
     std::string getParamName1() const { return "RMS"; }
     std::string getParamName2() const { return "R0"; }
     double calcParam1(double prec, const Nucleus &nuc) const { return nuc.getRMSRadius(); }
@@ -60,6 +44,18 @@ public:
         auto R0 = std::sqrt(RMS2*(5.0/3.0));
         return R0;
     }
+
+protected:
+    double evalNucleus(int i, double R1) const override {
+        auto Z = this->nuclei[i].getCharge();
+        auto R0 = this->param2[i];
+        if (R1 <= R0) {
+            return -(Z / (2.0*R0)) * (3.0 - (R1*R1)/(R0*R0));
+        } else {
+            return -(Z / R1);
+        }
+    }
+    double calcCutoff(int i) const override { return this->param2[i]; }
 };
 
 } // namespace mrchem
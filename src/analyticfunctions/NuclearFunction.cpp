@@ -89,17 +89,140 @@ bool NuclearFunction::isVisibleAtScale(int scale, int nQuadPts) const {
     return (scale >= visibleScale);
 }
 
+/** @brief Prepare screened evaluation of the nuclear potential
+ *
+ * @param leaf_size: edge length below which octree boxes are not divided
+ *
+ * Must be called after all nuclei have been added. Precomputes the
+ * short-range cutoff of each nucleus and sorts the nuclei into an octree.
+ */
+void NuclearFunction::setupScreening(double leaf_size) {
+    clearScreening();
+    if (this->nuclei.size() == 0) return;
+    if (leaf_size <= 0.0) MSG_ERROR("Invalid leaf size");
+
+    this->leaf_size = leaf_size;
+
+    mrcpp::Coord<3> r_min = this->nuclei[0].getCoord();
+    mrcpp::Coord<3> r_max = this->nuclei[0].getCoord();
+    for (int i = 0; i < this->nuclei.size(); i++) {
+        const auto &R = this->nuclei[i].getCoord();
+        for (int d = 0; d < 3; d++) r_min[d] = std::min(r_min[d], R[d]);
+        for (int d = 0; d < 3; d++) r_max[d] = std::max(r_max[d], R[d]);
+        this->cutoffs.push_back(calcCutoff(i));
+        this->order.push_back(i);
+    }
+
+    Node root;
+    root.first = 0;
+    root.last = this->nuclei.size();
+    root.corner = r_min;
+    root.size = leaf_size;
+    for (int d = 0; d < 3; d++) root.size = std::max(root.size, r_max[d] - r_min[d]);
+    this->tree.push_back(root);
+    buildNode(0);
+}
+
+/** @brief Recursively divide an octree box into its non-empty octants */
+void NuclearFunction::buildNode(int n) {
+    if (this->tree[n].last - this->tree[n].first < 2) return;
+    if (this->tree[n].size <= this->leaf_size) return;
+
+    // The tree vector grows below, so the node is accessed by index
+    double half = 0.5 * this->tree[n].size;
+    mrcpp::Coord<3> corner = this->tree[n].corner;
+    std::array<std::vector<int>, 8> octants;
+    for (int k = this->tree[n].first; k < this->tree[n].last; k++) {
+        const auto &R = this->nuclei[this->order[k]].getCoord();
+        int oct = 0;
+        for (int d = 0; d < 3; d++) {
+            if (R[d] >= corner[d] + half) oct += (1 << d);
+        }
+        octants[oct].push_back(this->order[k]);
+    }
+
+    int first = this->tree[n].first;
+    for (int oct = 0; oct < 8; oct++) {
+        if (octants[oct].size() == 0) continue;
+        Node child;
+        child.first = first;
+        child.last = first + octants[oct].size();
+        child.size = half;
+        for (int d = 0; d < 3; d++) child.corner[d] = corner[d] + ((oct >> d) & 1) * half;
+        for (auto i : octants[oct]) this->order[first++] = i;
+        this->tree[n].children.push_back(this->tree.size());
+        this->tree.push_back(child);
+    }
+    for (auto c : std::vector<int>(this->tree[n].children)) buildNode(c);
+}
+
+void NuclearFunction::clearScreening() {
+    this->leaf_size = -1.0;
+    this->cutoffs.clear();
+    this->order.clear();
+    this->tree.clear();
+}
+
+/** @brief Evaluate the potential of all nuclei
+ *
+ * Without screening all one-center terms are evaluated explicitly. With
+ * screening the smoothed expression is only evaluated within the cutoff of
+ * each nucleus, where it differs from the bare -Z/R.
+ */
+double NuclearFunction::evalf(const mrcpp::Coord<3> &r) const {
+    double result = 0.0;
+    if (not hasScreening()) {
+        for (int i = 0; i < this->nuclei.size(); i++) {
+            const auto &R = this->nuclei[i].getCoord();
+            result += evalNucleus(i, math_utils::calc_distance(R, r));
+        }
+        return result;
+    }
+    for (int i = 0; i < this->nuclei.size(); i++) {
+        const auto &R = this->nuclei[i].getCoord();
+        double R1 = math_utils::calc_distance(R, r);
+        if (R1 < this->cutoffs[i]) {
+            result += evalNucleus(i, R1);
+        } else {
+            result += -this->nuclei[i].getCharge() / R1;
+        }
+    }
+    return result;
+}
+
 bool NuclearFunction::isZeroOnInterval(const double *a, const double *b) const {
-    int totSplit = 0;
+    if (hasScreening()) return isZeroOnNode(0, a, b);
+
     for (int i = 0; i < this->nuclei.size(); i++) {
-        const mrcpp::Coord<3> &R = this->nuclei[i].getCoord();
-        int split = 1;
-        if (a[0] > R[0] or b[0] < R[0]) split = 0;
-        if (a[1] > R[1] or b[1] < R[1]) split = 0;
-        if (a[2] > R[2] or b[2] < R[2]) split = 0;
-        totSplit += split;
+        const auto &R = this->nuclei[i].getCoord();
+        if (a[0] > R[0] or b[0] < R[0]) continue;
+        if (a[1] > R[1] or b[1] < R[1]) continue;
+        if (a[2] > R[2] or b[2] < R[2]) continue;
+        return false;
+    }
+    return true;
+}
+
+/** @brief Check the nuclei of the octree boxes overlapping with the interval */
+bool NuclearFunction::isZeroOnNode(int n, const double *a, const double *b) const {
+    const Node &node = this->tree[n];
+    for (int d = 0; d < 3; d++) {
+        if (a[d] > node.corner[d] + node.size or b[d] < node.corner[d]) return true;
+    }
+    if (node.children.size() > 0) {
+        for (auto c : node.children) {
+            if (not isZeroOnNode(c, a, b)) return false;
+        }
+        return true;
+    }
+    for (int k = node.first; k < node.last; k++) {
+        const auto &R = this->nuclei[this->order[k]].getCoord();
+        if (a[0] > R[0] or b[0] < R[0]) continue;
+        if (a[1] > R[1] or b[1] < R[1]) continue;
+        if (a[2] > R[2] or b[2] < R[2]) continue;
+        return false;
     }
-    return (totSplit == 0);
+    return true;
 }
 
 } // namespace mrchem
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <array>
 #include <cmath>
 #include <vector>
 
@@ -32,6 +33,19 @@
 
 #include "chemistry/Nucleus.h"
 
+/** @class NuclearFunction
+ *
+ * @brief Smoothed nuclear potential for a collection of nuclei
+ *
+ * The potential is a sum of one-center terms, evalNucleus(), which for each
+ * model equal the bare -Z/R beyond a short cutoff radius, calcCutoff().
+ * With setupScreening() the smoothed expressions are only evaluated for
+ * nuclei within their cutoff of the point, all other nuclei contribute the
+ * bare -Z/R, which is exact. The nuclei are also sorted into an octree, such
+ * that isZeroOnInterval() only visits the nuclei of boxes overlapping with
+ * the interval. The 1/R tails are still summed nucleus by nucleus.
+ */
+
 namespace mrchem {
 
 class NuclearFunction : public mrcpp::RepresentableFunction<3> {
@@ -44,6 +58,10 @@ public:
     Nuclei &getNuclei() { return this->nuclei; }
     const Nuclei &getNuclei() const { return this->nuclei; }
 
+    void setupScreening(double leaf_size = 4.0);
+    void clearScreening();
+
+    double evalf(const mrcpp::Coord<3> &r) const override;
     bool isVisibleAtScale(int scale, int nQuadPts) const override;
     bool isZeroOnInterval(const double *a, const double *b) const override;
 
@@ -53,10 +71,33 @@ public:
     virtual double calcParam2(double prec, const Nucleus &nuc) const = 0;
 
 protected:
-    double prec;
+    double prec{-1.0};
     Nuclei nuclei;
     std::vector<double> param1;
     std::vector<double> param2;
+
+    /** @brief Potential from nucleus i at distance R1 */
+    virtual double evalNucleus(int i, double R1) const = 0;
+    /** @brief Distance beyond which evalNucleus(i, R1) equals -Z_i/R1 */
+    virtual double calcCutoff(int i) const = 0;
+
+private:
+    struct Node {
+        int first{0};              ///< First nucleus of this box in the sorted order
+        int last{0};               ///< One past the last nucleus of this box
+        std::vector<int> children; ///< Indices of non-empty child boxes
+        mrcpp::Coord<3> corner{};  ///< Lower corner of the box
+        double size{0.0};          ///< Edge length of the box
+    };
+
+    double leaf_size{-1.0};      ///< Edge length below which boxes are not divided
+    std::vector<double> cutoffs; ///< Short-range cutoff of each nucleus
+    std::vector<int> order;      ///< Nucleus indices sorted by octree box
+    std::vector<Node> tree;      ///< Octree boxes, the root box first
+
+    bool hasScreening() const { return (this->leaf_size > 0.0); }
+    void buildNode(int n);
+    bool isZeroOnNode(int n, const double *a, const double *b) const;
 };
 
 } // namespace mrchem
@@ -35,21 +35,6 @@ class PointNucleusHFYGB : public NuclearFunction {
 public:
     PointNucleusHFYGB() = default;
 
-    double evalf(const mrcpp::Coord<3> &r) const override {
-        double result = 0.0;
-        for (int i = 0; i < this->nuclei.size(); i++) {
-            const auto &R = this->nuclei[i].getCoord();
-            double R1 = math_utils::calc_distance(R, r);
-            double Z = this->nuclei[i].getCharge();
-            double S_i = this->param2[i];
-            R1 /= S_i;
-            double c = -1.0 / (3.0 * mrcpp::root_pi);
-            double partResult = -std::erf(R1) / R1 + c * (std::exp(-R1 * R1) + 16.0 * std::exp(-4.0 * R1 * R1));
-            result += Z * partResult / S_i;
-        }
-        return result;
-    }
-
     std::string getParamName1() const { return "Precision"; }
     std::string getParamName2() const { return "Smoothing"; }
     double calcParam1(double prec, const Nucleus &nuc) const { return prec; }
@@ -58,6 +43,18 @@ public:
         double tmp = 0.00435 * prec / std::pow(Z, 5.0);
         return std::cbrt(tmp);
     }
+
+protected:
+    double evalNucleus(int i, double R1) const override {
+        double Z = this->nuclei[i].getCharge();
+        double S_i = this->param2[i];
+        R1 /= S_i;
+        double c = -1.0 / (3.0 * mrcpp::root_pi);
+        double partResult = -std::erf(R1) / R1 + c * (std::exp(-R1 * R1) + 16.0 * std::exp(-4.0 * R1 * R1));
+        return Z * partResult / S_i;
+    }
+    // erfc(6) and exp(-36) are below machine precision
+    double calcCutoff(int i) const override { return 6.0 * this->param2[i]; }
 };
 
 } // namespace mrchem
@@ -25,10 +25,12 @@
 #include "chemistry_utils.h"
 #include "Nucleus.h"
 #include "PhysicalConstants.h"
+#include "analyticfunctions/NuclearGradientFunction.h"
 #include "qmfunctions/Density.h"
 #include "qmfunctions/density_utils.h"
 #include "utils/math_utils.h"
 #include <MRCPP/Gaussians>
+#include <MRCPP/Parallel>
 
 namespace mrchem {
 
@@ -78,4 +80,37 @@ Density chemistry::compute_nuclear_density(double prec, const Nuclei &nucs, doub
     density::compute(prec, rho, gauss);
     return rho;
 }
+
+/** @brief computes the electronic part of the Hellmann-Feynman nuclear gradient
+ *
+ * @param[in] prec precision used in the projection of the field functions
+ * @param[in] smoothing precision used in the smoothing parameter of the field functions
+ * @param[in] nucs the set of nuclei
+ * @param[in] rho the total electronic density
+ *
+ * The electronic contribution on nucleus k is the density integrated against
+ * the field Z_k (r - R_k)/|r - R_k|^3. This is the same quantity as the trace of
+ * the NuclearGradientOperator, but it is computed from the density once instead
+ * of applying the operator to each orbital. The nuclei are distributed among
+ * the MPI ranks, so the density must be available on all ranks.
+ */
+DoubleMatrix chemistry::compute_electronic_gradient(double prec, double smoothing, const Nuclei &nucs, Density &rho) {
+    int nNucs = nucs.size();
+    DoubleMatrix grad = DoubleMatrix::Zero(nNucs, 3);
+    for (int k = 0; k < nNucs; k++) {
+        if (k % mrcpp::mpi::wrk_size != mrcpp::mpi::wrk_rank) continue;
+        const Nucleus &nuc_k = nucs[k];
+        const double Z_k = nuc_k.getCharge();
+        const mrcpp::Coord<3> &R_k = nuc_k.getCoord();
+        const double c = detail::nuclear_gradient_smoothing(smoothing, Z_k, nNucs);
+        for (int d = 0; d < 3; d++) {
+            NuclearGradientFunction f_d(d, Z_k, R_k, c);
+            mrcpp::FunctionTree<3, double> f_tree(*MRA);
+            mrcpp::project(prec, f_tree, f_d);
+            grad(k, d) = mrcpp::dot(rho.real(), f_tree);
+        }
+    }
+    mrcpp::mpi::allreduce_matrix(grad, mrcpp::mpi::comm_wrk);
+    return grad;
+}
 } // namespace mrchem
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include "mrchem.h"
+
 #include "chemistry_fwd.h"
 #include "qmfunctions/qmfunction_fwd.h"
 
@@ -34,6 +36,7 @@ namespace chemistry {
 double compute_nuclear_repulsion(const Nuclei &nucs);
 Density compute_nuclear_density(double prec, const Nuclei &nucs, double alpha);
 double get_total_charge(const Nuclei &nucs);
+DoubleMatrix compute_electronic_gradient(double prec, double smoothing, const Nuclei &nucs, Density &rho);
 
 } // namespace chemistry
 } // namespace mrchem
@@ -28,6 +28,7 @@
 #include <MRCPP/Timer>
 
 #include "driver.h"
+#include <algorithm>
 #include <filesystem>
 
 #include "chemistry/Molecule.h"
@@ -54,7 +55,6 @@
 #include "qmoperators/one_electron/AZoraPotential.h"
 #include "qmoperators/one_electron/ElectricFieldOperator.h"
 #include "qmoperators/one_electron/KineticOperator.h"
-#include "qmoperators/one_electron/NuclearGradientOperator.h"
 #include "qmoperators/one_electron/NuclearOperator.h"
 #include "qmoperators/one_electron/ZoraOperator.h"
 
@@ -83,6 +83,7 @@
 #include "environment/LPBESolver.h"
 #include "environment/PBESolver.h"
 #include "environment/Permittivity.h"
+#include "properties/MomentEngine.h"
 #include "properties/hirshfeld/HirshfeldPartition.h"
 #include "surface_forces/SurfaceForce.h"
 
@@ -123,9 +124,17 @@ void plot_quantities(const json &input, Molecule &mol);
 } // namespace scf
 
 namespace rsp {
+/** @brief Converged perturbed orbitals of the previous calculation, per component */
+struct WarmStart {
+    json perturbation;
+    std::vector<std::shared_ptr<OrbitalVector>> X;
+    std::vector<std::shared_ptr<OrbitalVector>> Y;
+};
+json run_calculation(const json &input, Molecule &mol, FockBuilder &F_0, WarmStart &warm);
 bool guess_orbitals(const json &input, Molecule &mol);
-void write_orbitals(const json &input, Molecule &mol, bool dynamic);
-void calc_properties(const json &input, Molecule &mol, int dir, double omega);
+bool warm_start_orbitals(Molecule &mol, OrbitalVector &X_prev, OrbitalVector &Y_prev);
+void write_orbitals(const json &input, OrbitalVector &X, OrbitalVector &Y, bool dynamic);
+void calc_properties(const json &input, Molecule &mol, OrbitalVector &X, OrbitalVector &Y, int dir, double omega);
 } // namespace rsp
 
 } // namespace driver
@@ -239,10 +248,12 @@ void driver::init_properties(const json &json_prop, Molecule &mol) {
  * localized at exit. Returns a JSON record of the calculation.
  *
  * After convergence the requested ground-state properties are computed.
+ * If a handoff is given, the converged Fock operator is left set up and
+ * passed on, such that a subsequent response calculation can reuse it.
  *
  * This function expects the "scf_calculation" subsection of the input.
  */
-json driver::scf::run(const json &json_scf, Molecule &mol) {
+json driver::scf::run(const json &json_scf, Molecule &mol, FockHandoff *handoff) {
     // print_utils::headline(0, "Computing Ground State Wavefunction");
     json json_out = {{"success", true}};
     if (json_scf.contains("properties")) driver::init_properties(json_scf["properties"], mol);
@@ -250,7 +261,8 @@ json driver::scf::run(const json &json_scf, Molecule &mol) {
     ///////////////////////////////////////////////////////////
     ////////////////   Building Fock Operator   ///////////////
     ///////////////////////////////////////////////////////////
-    FockBuilder F;
+    auto F_p = std::make_shared<FockBuilder>();
+    FockBuilder &F = *F_p;
     const auto &json_fock = json_scf["fock_operator"];
     driver::build_fock_operator(json_fock, mol, F, 0);
 
@@ -286,6 +298,7 @@ json driver::scf::run(const json &json_scf, Molecule &mol) {
         auto max_iter = json_scf["scf_solver"]["max_iter"];
         auto rotation = json_scf["scf_solver"]["rotation"];
         auto localize = json_scf["scf_solver"]["localize"];
+        auto localize_method = json_scf["scf_solver"]["localize_method"];
         auto file_chk = json_scf["scf_solver"]["file_chk"];
         auto checkpoint = json_scf["scf_solver"]["checkpoint"];
         auto start_prec = json_scf["scf_solver"]["start_prec"];
@@ -298,6 +311,7 @@ json driver::scf::run(const json &json_scf, Molecule &mol) {
         solver.setHistory(kain);
         solver.setRotation(rotation);
         solver.setLocalize(localize);
+        solver.setLocalizeMethod(localize_method);
         solver.setMethodName(method);
         solver.setRelativityName(relativity);
         solver.setEnvironmentName(environment);
@@ -309,8 +323,23 @@ json driver::scf::run(const json &json_scf, Molecule &mol) {
         solver.setOrbitalPrec(start_prec, final_prec);
         solver.setThreshold(orbital_thrs, energy_thrs);
 
+        bool keep_operator = (handoff != nullptr) or json_scf.contains("write_operators");
+        solver.setKeepOperator(keep_operator);
+
         json_out["scf_solver"] = solver.optimize(mol, F);
         json_out["success"] = json_out["scf_solver"]["converged"];
+
+        if (keep_operator) {
+            bool converged = json_out["success"];
+            if (converged and json_scf.contains("write_operators")) F.saveOperators(json_scf["write_operators"]["file_operators"], mol.getOrbitals());
+            if (converged and handoff != nullptr) {
+                handoff->F = F_p;
+                handoff->fock_operator = json_fock;
+                handoff->prec = F.getPrecision();
+            } else {
+                F.clear();
+            }
+        }
     }
 
     ///////////////////////////////////////////////////////////
@@ -342,6 +371,7 @@ bool driver::scf::guess_orbitals(const json &json_guess, Molecule &mol) {
     auto zeta = json_guess["zeta"];
     auto type = json_guess["type"];
     auto screen = json_guess["screen"];
+    bool fragments = json_guess["fragments"];
     auto mw_p = json_guess["file_phi_p"];
     auto mw_a = json_guess["file_phi_a"];
     auto mw_b = json_guess["file_phi_b"];
@@ -355,6 +385,14 @@ bool driver::scf::guess_orbitals(const json &json_guess, Molecule &mol) {
     auto cube_a = json_guess["file_CUBE_a"];
     auto cube_b = json_guess["file_CUBE_b"];
 
+    // Orbitals already placed on the molecule, e.g. carried over from a previous geometry
+    if (type == "none") {
+        auto &Phi = mol.getOrbitals();
+        if (Phi.size() == 0) MSG_ERROR("No orbitals to start from");
+        orbital::print(Phi);
+        return (Phi.size() > 0);
+    }
+
     int mult = mol.getMultiplicity();
     if (restricted && mult != 1) {
         MSG_ERROR("Restricted open-shell not supported");
@@ -391,9 +429,9 @@ bool driver::scf::guess_orbitals(const json &json_guess, Molecule &mol) {
     } else if (type == "core") {
         success = initial_guess::core::setup(Phi, prec, nucs, zeta);
     } else if (type == "sad") {
-        success = initial_guess::sad::setup(Phi, prec, screen, nucs, zeta);
+        success = initial_guess::sad::setup(Phi, prec, screen, nucs, initial_guess::sad::AOBasis::Hydrogen, zeta, fragments);
     } else if (type == "sad_gto") {
-        success = initial_guess::sad::setup(Phi, prec, screen, nucs);
+        success = initial_guess::sad::setup(Phi, prec, screen, nucs, initial_guess::sad::AOBasis::GTO, zeta, fragments);
     } else if (type == "gto") {
         success = initial_guess::gto::setup(Phi, prec, screen, gto_bas, gto_p, gto_a, gto_b);
     } else if (type == "cube") {
@@ -489,6 +527,35 @@ void driver::scf::calc_properties(const json &json_prop, Molecule &mol, const js
     auto &F_mat = mol.getFockMatrix();
     auto &nuclei = mol.getNuclei();
 
+    // Cartesian moments shared by all pure position operators (dipole, quadrupole
+    // and diamagnetic magnetizability), integrated once for every requested origin
+    std::unique_ptr<MomentEngine> el_moments{nullptr};
+    std::unique_ptr<MomentEngine> nuc_moments{nullptr};
+    {
+        int order = -1;
+        double prec = 1.0;
+        auto request = [&order, &prec](const json &json_items, const std::string &key, const std::string &name, int o) {
+            for (const auto &item : json_items.items()) {
+                if (item.value()[key] != name) continue;
+                order = std::max(order, o);
+                prec = std::min(prec, item.value()["precision"].get<double>());
+            }
+        };
+        if (json_prop.contains("dipole_moment")) request(json_prop["dipole_moment"], "operator", "h_e_dip", 1);
+        if (json_prop.contains("quadrupole_moment")) request(json_prop["quadrupole_moment"], "operator", "h_e_quad", 2);
+        if (json_prop.contains("magnetizability")) request(json_prop["magnetizability"], "dia_operator", "h_bb_dia", 2);
+
+        if (order >= 0) {
+            t_lap.start();
+            Density rho(false);
+            density::compute(prec, rho, Phi, DensityType::Total);
+            el_moments = std::make_unique<MomentEngine>(order, prec, rho);
+            nuc_moments = std::make_unique<MomentEngine>(order, nuclei);
+            rho.free();
+            if (plevel == 1) mrcpp::print::time(1, "Cartesian moments", t_lap);
+        }
+    }
+
     if (json_prop.contains("dipole_moment")) {
         t_lap.start();
         mrcpp::print::header(2, "Computing dipole moment");
@@ -496,12 +563,19 @@ void driver::scf::calc_properties(const json &json_prop, Molecule &mol, const js
             const auto &id = item.key();
             const auto &prec = item.value()["precision"];
             const auto &oper_name = item.value()["operator"];
-            auto h = driver::get_operator<3>(oper_name, item.value());
-            h.setup(prec);
             DipoleMoment &mu = mol.getDipoleMoment(id);
-            mu.getNuclear() = -h.trace(nuclei).real();
-            mu.getElectronic() = h.trace(Phi).real();
-            h.clear();
+            if (oper_name == "h_e_dip") {
+                // h_e_dip = -(r - r_O)
+                const auto &r_O = mu.getOrigin();
+                mu.getNuclear() = nuc_moments->getFirstMoment(r_O);
+                mu.getElectronic() = -el_moments->getFirstMoment(r_O);
+            } else {
+                auto h = driver::get_operator<3>(oper_name, item.value());
+                h.setup(prec);
+                mu.getNuclear() = -h.trace(nuclei).real();
+                mu.getElectronic() = h.trace(Phi).real();
+                h.clear();
+            }
         }
         mrcpp::print::footer(2, t_lap, 2);
         if (plevel == 1) mrcpp::print::time(1, "Dipole moment", t_lap);
@@ -514,12 +588,21 @@ void driver::scf::calc_properties(const json &json_prop, Molecule &mol, const js
             const auto &id = item.key();
             const auto &prec = item.value()["precision"];
             const auto &oper_name = item.value()["operator"];
-            auto h = driver::get_operator<3, 3>(oper_name, item.value());
-            h.setup(prec);
             QuadrupoleMoment &Q = mol.getQuadrupoleMoment(id);
-            Q.getNuclear() = -h.trace(nuclei).real();
-            Q.getElectronic() = h.trace(Phi).real();
-            h.clear();
+            if (oper_name == "h_e_quad") {
+                // h_e_quad = -3/2 (r - r_O)(r - r_O)^T + 1/2 |r - r_O|^2 1
+                const auto &r_O = Q.getOrigin();
+                DoubleMatrix S_nuc = nuc_moments->getSecondMoment(r_O);
+                DoubleMatrix S_el = el_moments->getSecondMoment(r_O);
+                Q.getNuclear() = 1.5 * S_nuc - 0.5 * S_nuc.trace() * DoubleMatrix::Identity(3, 3);
+                Q.getElectronic() = -1.5 * S_el + 0.5 * S_el.trace() * DoubleMatrix::Identity(3, 3);
+            } else {
+                auto h = driver::get_operator<3, 3>(oper_name, item.value());
+                h.setup(prec);
+                Q.getNuclear() = -h.trace(nuclei).real();
+                Q.getElectronic() = h.trace(Phi).real();
+                h.clear();
+            }
         }
         mrcpp::print::footer(2, t_lap, 2);
         if (plevel == 1) mrcpp::print::time(1, "Quadrupole moment", t_lap);
@@ -553,16 +636,11 @@ void driver::scf::calc_properties(const json &json_prop, Molecule &mol, const js
             const double &smoothing = json_prop["geometric_derivative"]["geom-1"]["smoothing"];
             auto &el = G.getElectronic();
 
-            for (auto k = 0; k < mol.getNNuclei(); ++k) {
-                const auto nuc_k = nuclei[k];
-                auto Z_k = nuc_k.getCharge();
-                auto R_k = nuc_k.getCoord();
-                double c = detail::nuclear_gradient_smoothing(smoothing, Z_k, mol.getNNuclei());
-                NuclearGradientOperator h(Z_k, R_k, prec, c);
-                h.setup(prec);
-                el.row(k) = h.trace(Phi).real();
-                h.clear();
-            }
+            // integrate the density against the field of all nuclei
+            Density rho(false);
+            density::compute(prec, rho, Phi, DensityType::Total);
+            el = chemistry::compute_electronic_gradient(prec, smoothing, nuclei, rho);
+            rho.free();
             // calculate electronic gradient using the surface integrals method
         } else if (json_prop["geometric_derivative"]["geom-1"]["method"] == "surface_integrals") {
             double prec = json_prop["geometric_derivative"]["geom-1"]["precision"];
@@ -588,11 +666,17 @@ void driver::scf::calc_properties(const json &json_prop, Molecule &mol, const js
             const auto &id = item.key();
             const auto &prec = item.value()["precision"];
             const auto &oper_name = item.value()["dia_operator"];
-            auto h = driver::get_operator<3, 3>(oper_name, item.value());
-            h.setup(prec);
             Magnetizability &xi = mol.getMagnetizability(id);
-            xi.getDiamagnetic() = -h.trace(Phi).real();
-            h.clear();
+            if (oper_name == "h_bb_dia") {
+                // h_bb_dia = 1/4 (|r - r_O|^2 1 - (r - r_O)(r - r_O)^T)
+                DoubleMatrix S_el = el_moments->getSecondMoment(xi.getOrigin());
+                xi.getDiamagnetic() = -0.25 * (S_el.trace() * DoubleMatrix::Identity(3, 3) - S_el);
+            } else {
+                auto h = driver::get_operator<3, 3>(oper_name, item.value());
+                h.setup(prec);
+                xi.getDiamagnetic() = -h.trace(Phi).real();
+                h.clear();
+            }
         }
         mrcpp::print::footer(2, t_lap, 2);
         if (plevel == 1) mrcpp::print::time(1, "Magnetizability (dia)", t_lap);
@@ -635,14 +719,9 @@ void driver::scf::calc_properties(const json &json_prop, Molecule &mol, const js
             HirshfeldPartition partitioner(mol, data_dir);
             mrchem::Density rho(false);
             mrchem::density::compute(prec, rho, Phi, DensityType::Total);
-            Eigen::VectorXd charges = Eigen::VectorXd::Zero(mol.getNNuclei());
-            for (int i = 0; i < mol.getNNuclei(); i++) {
-                if (!mrcpp::mpi::my_func(i)) continue; // my_orb also works for atoms.
-                double charge = partitioner.getHirshfeldPartitionIntegral(i, rho, prec);
-                charge = -charge + mol.getNuclei()[i].getCharge();
-                charges(i) = charge;
-            }
-            mrcpp::mpi::allreduce_vector(charges, mrcpp::mpi::comm_wrk);
+            Eigen::VectorXd charges = -partitioner.getHirshfeldPartitionIntegrals(rho, prec);
+            for (int i = 0; i < mol.getNNuclei(); i++) charges(i) += mol.getNuclei()[i].getCharge();
+            rho.free();
             HirshfeldCharges &hir = mol.getHirshfeldCharges(id);
             hir.setVector(charges);
         }
@@ -766,53 +845,104 @@ void driver::scf::plot_quantities(const json &json_plot, Molecule &mol) {
     mrcpp::print::footer(1, t_tot, 2);
 }
 
+/** @brief Run all linear response SCF calculations
+ *
+ * This function expects the full "rsp_calculations" section of the input,
+ * and returns a JSON record with one entry per calculation. Consecutive
+ * calculations with the same unperturbed system share the unperturbed Fock
+ * operator, and calculations with the same perturbation operator (e.g. the
+ * frequencies of a dispersion curve, which come in increasing order) are
+ * warm-started from the converged orbitals of the previous frequency.
+ *
+ * The unperturbed Fock operator is taken over from the ground-state
+ * calculation through the handoff if it was built from the same input with
+ * at least the required precision. Otherwise it is rebuilt, optionally from
+ * the density and Coulomb potential written by a previous calculation.
+ */
+json driver::rsp::run(const json &json_rsps, Molecule &mol, FockHandoff *handoff) {
+    json json_out = {};
+    json json_unpert;
+    std::shared_ptr<FockBuilder> F_0{nullptr};
+    rsp::WarmStart warm;
+
+    for (const auto &item : json_rsps.items()) {
+        const auto &json_rsp = item.value();
+        if (json_rsp["unperturbed"] != json_unpert) {
+            ///////////////////////////////////////////////////////////
+            /////////////   Preparing Unperturbed System   ////////////
+            ///////////////////////////////////////////////////////////
+
+            Timer t_unpert;
+            auto plevel = Printer::getPrintLevel();
+            print_utils::headline(0, "Preparing Linear Response Calculations");
+            if (plevel == 1) mrcpp::print::header(1, "Preparing unperturbed system");
+
+            json_unpert = json_rsp["unperturbed"];
+            const auto &unpert_fock = json_unpert["fock_operator"];
+            auto unpert_loc = json_unpert["localize"];
+            auto unpert_prec = json_unpert["precision"];
+
+            auto &Phi = mol.getOrbitals();
+            auto &F_mat = mol.getFockMatrix();
+
+            ComplexMatrix U_mat;
+            if (unpert_loc) {
+                U_mat = orbital::localize(unpert_prec, Phi, F_mat);
+            } else {
+                U_mat = orbital::diagonalize(unpert_prec, Phi, F_mat);
+            }
+
+            if (F_0 != nullptr) F_0->clear();
+            F_0 = nullptr;
+            if (handoff != nullptr and handoff->F != nullptr) {
+                if (handoff->fock_operator == unpert_fock and handoff->prec <= unpert_prec) {
+                    // The converged ground-state operator only needs to follow the rotation
+                    F_0 = handoff->F;
+                    F_0->rotate(U_mat);
+                    print_utils::text(1, "Fock operator", "Reused from SCF");
+                } else {
+                    handoff->F->clear();
+                }
+                handoff->F = nullptr;
+            }
+            if (F_0 == nullptr) {
+                F_0 = std::make_shared<FockBuilder>();
+                driver::build_fock_operator(unpert_fock, mol, *F_0, 0);
+                if (json_unpert.contains("read_operators")) F_0->loadOperators(unpert_prec, json_unpert["read_operators"]["file_operators"], Phi);
+                F_0->setup(unpert_prec);
+            }
+            warm = rsp::WarmStart();
+            if (plevel == 1) mrcpp::print::footer(1, t_unpert, 2);
+        }
+        json_out[item.key()] = rsp::run_calculation(json_rsp, mol, *F_0, warm);
+    }
+    if (F_0 != nullptr) F_0->clear();
+    mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
+
+    return json_out;
+}
+
 /** @brief Run linear response SCF calculation
  *
- * This function will update the perturbed orbitals of the molecule
+ * This function will compute the perturbed orbitals of the molecule
  * based on the chosen electronic structure method and perturbation
  * operator. Each response calculation corresponds to one particular
  * perturbation operator (could be a vector operator with several
- * components). Returns a JSON record of the calculation.
+ * components). All components are optimized simultaneously as one
+ * block, sharing the unperturbed operators and Helmholtz kernels.
+ * Returns a JSON record of the calculation.
  *
  * After convergence the requested linear response properties are computed.
  *
  * This function expects a single subsection entry in the "rsp_calculations"
- * vector of the input.
+ * vector of the input, and an unperturbed Fock operator which is set up.
  */
-json driver::rsp::run(const json &json_rsp, Molecule &mol) {
+json driver::rsp::run_calculation(const json &json_rsp, Molecule &mol, FockBuilder &F_0, WarmStart &warm) {
     print_utils::headline(0, "Computing Linear Response Wavefunction");
     json json_out = {{"success", true}};
 
     if (json_rsp.contains("properties")) driver::init_properties(json_rsp["properties"], mol);
-
-    ///////////////////////////////////////////////////////////
-    /////////////   Preparing Unperturbed System   ////////////
-    ///////////////////////////////////////////////////////////
-
-    Timer t_unpert;
-    auto plevel = Printer::getPrintLevel();
-    if (plevel == 1) mrcpp::print::header(1, "Preparing unperturbed system");
-
-    const auto &json_unpert = json_rsp["unperturbed"];
-    const auto &unpert_fock = json_unpert["fock_operator"];
-    auto unpert_loc = json_unpert["localize"];
-    auto unpert_prec = json_unpert["precision"];
-
-    auto &Phi = mol.getOrbitals();
-    auto &F_mat = mol.getFockMatrix();
-
-    if (unpert_loc) {
-        orbital::localize(unpert_prec, Phi, F_mat);
-    } else {
-        orbital::diagonalize(unpert_prec, Phi, F_mat);
-    }
-
-    FockBuilder F_0;
-    driver::build_fock_operator(unpert_fock, mol, F_0, 0);
-    F_0.setup(unpert_prec);
-    if (plevel == 1) mrcpp::print::footer(1, t_unpert, 2);
-
-    if (json_rsp.contains("properties")) scf::calc_properties(json_rsp["properties"], mol, unpert_fock);
+    if (json_rsp.contains("properties")) scf::calc_properties(json_rsp["properties"], mol, json_rsp["unperturbed"]["fock_operator"]);
 
     ///////////////////////////////////////////////////////////
     //////////////   Preparing Perturbed System   /////////////
@@ -820,78 +950,108 @@ json driver::rsp::run(const json &json_rsp, Molecule &mol) {
 
     auto omega = json_rsp["frequency"];
     auto dynamic = json_rsp["dynamic"];
-    mol.initPerturbedOrbitals(dynamic);
-
-    FockBuilder F_1;
     const auto &json_fock_1 = json_rsp["fock_operator"];
-    driver::build_fock_operator(json_fock_1, mol, F_1, 1, dynamic);
-
     const auto &json_pert = json_rsp["perturbation"];
     auto h_1 = driver::get_operator<3>(json_pert["operator"], json_pert);
     json_out["perturbation"] = json_pert["operator"];
     json_out["frequency"] = omega;
     json_out["components"] = {};
+
+    bool use_warm = (warm.perturbation == json_pert);
+    std::vector<std::shared_ptr<OrbitalVector>> X_p(3);
+    std::vector<std::shared_ptr<OrbitalVector>> Y_p(3);
+    std::vector<std::unique_ptr<FockBuilder>> F_1(3);
+    std::vector<bool> success(3, false);
+    std::vector<json> comp_out(3);
+
+    std::vector<int> block_dirs;
+    std::vector<ResponseComponent> block;
     for (auto d = 0; d < 3; d++) {
-        json comp_out = {};
         const auto &json_comp = json_rsp["components"][d];
-        F_1.perturbation() = h_1[d];
 
         ///////////////////////////////////////////////////////////
         ///////////////   Setting Up Initial Guess   //////////////
         ///////////////////////////////////////////////////////////
 
+        mol.initPerturbedOrbitals(dynamic);
         const auto &json_guess = json_comp["initial_guess"];
-        json_out["success"] = rsp::guess_orbitals(json_guess, mol);
+        success[d] = rsp::guess_orbitals(json_guess, mol);
+        if (json_guess["type"] == "none" and use_warm and warm.X[d] != nullptr) {
+            success[d] = rsp::warm_start_orbitals(mol, *warm.X[d], *warm.Y[d]);
+        }
+        X_p[d] = mol.getOrbitalsX_p();
+        Y_p[d] = mol.getOrbitalsY_p();
 
-        ///////////////////////////////////////////////////////////
-        /////////////   Optimizing Perturbed Orbitals  ////////////
-        ///////////////////////////////////////////////////////////
+        // The perturbed Fock operator refers to the orbitals of this component
+        F_1[d] = std::make_unique<FockBuilder>();
+        driver::build_fock_operator(json_fock_1, mol, *F_1[d], 1, dynamic);
+        F_1[d]->perturbation() = h_1[d];
 
         if (json_comp.contains("rsp_solver")) {
-            auto kain = json_comp["rsp_solver"]["kain"];
-            auto method = json_comp["rsp_solver"]["method"];
-            auto max_iter = json_comp["rsp_solver"]["max_iter"];
-            auto file_chk_x = json_comp["rsp_solver"]["file_chk_x"];
-            auto file_chk_y = json_comp["rsp_solver"]["file_chk_y"];
-            auto checkpoint = json_comp["rsp_solver"]["checkpoint"];
-            auto orth_prec = json_comp["rsp_solver"]["orth_prec"];
-            auto start_prec = json_comp["rsp_solver"]["start_prec"];
-            auto final_prec = json_comp["rsp_solver"]["final_prec"];
-            auto orbital_thrs = json_comp["rsp_solver"]["orbital_thrs"];
-            auto property_thrs = json_comp["rsp_solver"]["property_thrs"];
-            auto helmholtz_prec = json_comp["rsp_solver"]["helmholtz_prec"];
-
-            LinearResponseSolver solver(dynamic);
-            solver.setHistory(kain);
-            solver.setMethodName(method);
-            solver.setMaxIterations(max_iter);
-            solver.setCheckpoint(checkpoint);
-            solver.setCheckpointFile(file_chk_x, file_chk_y);
-            solver.setHelmholtzPrec(helmholtz_prec);
-            solver.setOrbitalPrec(start_prec, final_prec);
-            solver.setThreshold(orbital_thrs, property_thrs);
-            solver.setOrthPrec(orth_prec);
-
-            comp_out["rsp_solver"] = solver.optimize(omega, mol, F_0, F_1);
-            json_out["success"] = comp_out["rsp_solver"]["converged"];
+            const auto &json_solver = json_comp["rsp_solver"];
+            block.push_back({F_1[d].get(), X_p[d], Y_p[d], json_solver["file_chk_x"].get<std::string>(), json_solver["file_chk_y"].get<std::string>()});
+            block_dirs.push_back(d);
         }
+    }
 
-        ///////////////////////////////////////////////////////////
-        ////////////   Compute Response Properties   //////////////
-        ///////////////////////////////////////////////////////////
+    ///////////////////////////////////////////////////////////
+    /////////////   Optimizing Perturbed Orbitals  ////////////
+    ///////////////////////////////////////////////////////////
+
+    if (not block.empty()) {
+        const auto &json_solver = json_rsp["components"][block_dirs[0]]["rsp_solver"];
+        auto kain = json_solver["kain"];
+        auto method = json_solver["method"];
+        auto max_iter = json_solver["max_iter"];
+        auto checkpoint = json_solver["checkpoint"];
+        auto orth_prec = json_solver["orth_prec"];
+        auto start_prec = json_solver["start_prec"];
+        auto final_prec = json_solver["final_prec"];
+        auto orbital_thrs = json_solver["orbital_thrs"];
+        auto property_thrs = json_solver["property_thrs"];
+        auto helmholtz_prec = json_solver["helmholtz_prec"];
+
+        LinearResponseSolver solver(dynamic);
+        solver.setHistory(kain);
+        solver.setMethodName(method);
+        solver.setMaxIterations(max_iter);
+        solver.setCheckpoint(checkpoint);
+        solver.setHelmholtzPrec(helmholtz_prec);
+        solver.setOrbitalPrec(start_prec, final_prec);
+        solver.setThreshold(orbital_thrs, property_thrs);
+        solver.setOrthPrec(orth_prec);
+
+        auto json_block = solver.optimize(omega, mol, F_0, block);
+        for (auto k = 0; k < block_dirs.size(); k++) {
+            auto d = block_dirs[k];
+            comp_out[d]["rsp_solver"] = json_block["components"][k];
+            success[d] = comp_out[d]["rsp_solver"]["converged"];
+        }
+    }
 
-        if (json_out["success"]) {
-            if (json_comp.contains("write_orbitals")) rsp::write_orbitals(json_comp["write_orbitals"], mol, dynamic);
-            if (json_rsp.contains("properties")) rsp::calc_properties(json_rsp["properties"], mol, d, omega);
+    ///////////////////////////////////////////////////////////
+    ////////////   Compute Response Properties   //////////////
+    ///////////////////////////////////////////////////////////
+
+    for (auto d = 0; d < 3; d++) {
+        const auto &json_comp = json_rsp["components"][d];
+        if (success[d]) {
+            if (json_comp.contains("write_orbitals")) rsp::write_orbitals(json_comp["write_orbitals"], *X_p[d], *Y_p[d], dynamic);
+            if (json_rsp.contains("properties")) rsp::calc_properties(json_rsp["properties"], mol, *X_p[d], *Y_p[d], d, omega);
         }
-        mol.getOrbitalsX().clear(); // Clear orbital vector
-        mol.getOrbitalsY().clear(); // Clear orbital vector
-        json_out["components"].push_back(comp_out);
+        json_out["components"].push_back(comp_out[d]);
+    }
+    json_out["success"] = std::all_of(success.begin(), success.end(), [](bool s) { return s; });
+
+    // Keep the converged orbitals as starting point for the next frequency
+    warm = rsp::WarmStart();
+    warm.perturbation = json_pert;
+    for (auto d = 0; d < 3; d++) {
+        warm.X.push_back((success[d]) ? X_p[d] : nullptr);
+        warm.Y.push_back((success[d]) ? Y_p[d] : nullptr);
     }
-    F_0.clear();
     mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
-    mol.getOrbitalsX_p().reset(); // Release shared_ptr
-    mol.getOrbitalsY_p().reset(); // Release shared_ptr
+    mol.initPerturbedOrbitals(dynamic); // Release the orbitals of the last component
 
     return json_out;
 }
@@ -969,13 +1129,34 @@ bool driver::rsp::guess_orbitals(const json &json_guess, Molecule &mol) {
     return (success_x and success_y);
 }
 
-void driver::rsp::write_orbitals(const json &json_orbs, Molecule &mol, bool dynamic) {
+/** @brief Use converged perturbed orbitals from a neighbouring frequency as guess
+ *
+ * The guess is copied, so that the previous solution is left untouched. For a
+ * dynamic calculation starting from a static solution, X and Y both start
+ * from the static orbitals.
+ */
+bool driver::rsp::warm_start_orbitals(Molecule &mol, OrbitalVector &X_prev, OrbitalVector &Y_prev) {
+    mrcpp::print::separator(0, '~');
+    print_utils::text(0, "Calculation     ", "Compute initial orbitals");
+    print_utils::text(0, "Method          ", "Previous frequency");
+    mrcpp::print::separator(0, '~', 2);
+
     auto &X = mol.getOrbitalsX();
+    auto &Y = mol.getOrbitalsY();
+    X = orbital::deep_copy(X_prev);
+    orbital::print(X);
+    if (&X != &Y) {
+        Y = orbital::deep_copy(Y_prev);
+        orbital::print(Y);
+    }
+    return true;
+}
+
+void driver::rsp::write_orbitals(const json &json_orbs, OrbitalVector &X, OrbitalVector &Y, bool dynamic) {
     orbital::save_orbitals(X, json_orbs["file_x_p"], SPIN::Paired);
     orbital::save_orbitals(X, json_orbs["file_x_a"], SPIN::Alpha);
     orbital::save_orbitals(X, json_orbs["file_x_b"], SPIN::Beta);
     if (dynamic) {
-        auto &Y = mol.getOrbitalsY();
         orbital::save_orbitals(Y, json_orbs["file_y_p"], SPIN::Paired);
         orbital::save_orbitals(Y, json_orbs["file_y_a"], SPIN::Alpha);
         orbital::save_orbitals(Y, json_orbs["file_y_b"], SPIN::Beta);
@@ -987,14 +1168,12 @@ void driver::rsp::write_orbitals(const json &json_orbs, Molecule &mol, bool dyna
  * This function expects the "properties" subsection of the "rsp_calculations"
  * input section, and will compute all properties which are present in this input.
  */
-void driver::rsp::calc_properties(const json &json_prop, Molecule &mol, int dir, double omega) {
+void driver::rsp::calc_properties(const json &json_prop, Molecule &mol, OrbitalVector &X, OrbitalVector &Y, int dir, double omega) {
     Timer t_tot, t_lap;
     auto plevel = Printer::getPrintLevel();
     if (plevel == 1) mrcpp::print::header(1, "Computing linear response properties");
 
     auto &Phi = mol.getOrbitals();
-    auto &X = mol.getOrbitalsX();
-    auto &Y = mol.getOrbitalsY();
 
     if (json_prop.contains("polarizability")) {
         t_lap.start();
@@ -1133,12 +1312,17 @@ void driver::build_fock_operator(const json &json_fock, Molecule &mol, FockBuild
     if (json_fock.contains("coulomb_operator")) {
         auto poisson_prec = json_fock["coulomb_operator"]["poisson_prec"];
         auto shared_memory = json_fock["coulomb_operator"]["shared_memory"];
+        auto distributed = false;
+        if (json_fock["coulomb_operator"].contains("distributed")) distributed = json_fock["coulomb_operator"]["distributed"];
         auto P_p = std::make_shared<PoissonOperator>(*MRA, poisson_prec);
         if (order == 0) {
             auto J_p = std::make_shared<CoulombOperator>(P_p, Phi_p, shared_memory);
+            if (json_fock["coulomb_operator"].contains("refresh_interval")) J_p->setRefreshInterval(json_fock["coulomb_operator"]["refresh_interval"]);
+            J_p->setDistributed(distributed);
             F.getCoulombOperator() = J_p;
         } else if (order == 1) {
             auto J_p = std::make_shared<CoulombOperator>(P_p, Phi_p, X_p, Y_p, shared_memory);
+            J_p->setDistributed(distributed);
             F.getCoulombOperator() = J_p;
         } else {
             MSG_ABORT("Invalid perturbation order");
@@ -1232,6 +1416,7 @@ void driver::build_fock_operator(const json &json_fock, Molecule &mol, FockBuild
         } else {
             MSG_ERROR("Solver type not implemented");
         }
+        if (json_fock["reaction_operator"].contains("newton")) scrf_p->setNewtonSolver(json_fock["reaction_operator"]["newton"]);
 
         // initialize reaction potential object
         auto V_R = [&] {
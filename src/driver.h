@@ -23,23 +23,33 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <memory>
+
 #include <nlohmann/json.hpp>
 
 namespace mrchem {
 
 class Molecule;
 class CUBEfunction;
+class FockBuilder;
 namespace driver {
 
+/** @brief Converged ground-state Fock operator handed from the SCF to the response stage */
+struct FockHandoff {
+    std::shared_ptr<FockBuilder> F{nullptr}; ///< Operator which is still set up
+    nlohmann::json fock_operator;            ///< Input section the operator was built from
+    double prec{-1.0};                       ///< Precision of the last setup
+};
+
 void init_molecule(const nlohmann::json &input, Molecule &mol);
 nlohmann::json print_properties(const Molecule &mol);
 std::vector<mrchem::CUBEfunction> getCUBEFunction(const nlohmann::json &json_inp);
 
 namespace scf {
-nlohmann::json run(const nlohmann::json &input, Molecule &mol);
+nlohmann::json run(const nlohmann::json &input, Molecule &mol, FockHandoff *handoff = nullptr);
 }
 namespace rsp {
-nlohmann::json run(const nlohmann::json &input, Molecule &mol);
+nlohmann::json run(const nlohmann::json &input, Molecule &mol, FockHandoff *handoff = nullptr);
 }
 
 } // namespace driver
@@ -24,6 +24,7 @@
  */
 #include "Cavity.h"
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 #include <vector>
@@ -59,7 +60,6 @@ namespace detail {
 auto gradCavity(const mrcpp::Coord<3> &r, int index, const std::vector<mrcpp::Coord<3>> &centers, const std::vector<double> &radii, const std::vector<double> &widths) -> double {
     auto C = 1.0;
     auto DC = 0.0;
-    auto sqrt_pi = std::sqrt(mrcpp::pi);
 
     for (int i = 0; i < centers.size(); ++i) {
         auto center = centers[i];
@@ -68,30 +68,45 @@ auto gradCavity(const mrcpp::Coord<3> &r, int index, const std::vector<mrcpp::Co
 
         auto s = math_utils::calc_distance(center, r) - radius;
         auto ds = (r[index] - center[index]) / (math_utils::calc_distance(center, r));
-        auto Theta = 0.5 * (1 + std::erf(s / sigma));
-        auto Ci = 1.0 - Theta;
-        C *= 1.0 - Ci;
+        auto Theta = 1.0;
+        DC += gradCavityTerm(s, sigma, ds, Theta);
+        C *= Theta;
+    }
+    DC = C * DC;
+    return DC;
+}
 
-        double DCi = -(1.0 / (sigma * sqrt_pi)) * std::exp(-std::pow(s / sigma, 2.0)) * ds;
+/**  @relates mrchem::Cavity
+ *   @brief Contribution of a single sphere to the gradient of the Cavity.
+ *   @param s signed normal distance from the surface of the sphere.
+ *   @param sigma width of the sphere boundary.
+ *   @param ds derivative of s wrt. the variable of differentiation.
+ *   @param theta output, the sphere factor \f$\frac{1}{2}(1 + \operatorname{erf}(s/\sigma))\f$ of \f$1 - C\f$.
+ *   @return The term of the sum over spheres in gradCavity(), with the numerator and denominator kept away from zero.
+ */
+auto gradCavityTerm(double s, double sigma, double ds, double &theta) -> double {
+    auto sqrt_pi = std::sqrt(mrcpp::pi);
+    auto Theta = 0.5 * (1 + std::erf(s / sigma));
+    auto Ci = 1.0 - Theta;
+    theta = 1.0 - Ci;
 
-        double numerator = DCi;
-        double denominator = 1.0 - Ci;
+    double DCi = -(1.0 / (sigma * sqrt_pi)) * std::exp(-std::pow(s / sigma, 2.0)) * ds;
 
-        if (((1.0 - Ci) < 1.0e-12) and ((1.0 - Ci) >= 0)) {
-            denominator = 1.0e-12;
-        } else if (((1.0 - Ci) > -1.0e-12) and ((1.0 - Ci) <= 0)) {
-            denominator = -1.0e-12;
-        }
+    double numerator = DCi;
+    double denominator = 1.0 - Ci;
 
-        if ((DCi < 1.0e-12) and (DCi >= 0)) {
-            numerator = 1.0e-12;
-        } else if ((DCi > -1.0e-12) and (DCi <= 0)) {
-            numerator = -1.0e-12;
-        }
-        DC += numerator / denominator;
+    if (((1.0 - Ci) < 1.0e-12) and ((1.0 - Ci) >= 0)) {
+        denominator = 1.0e-12;
+    } else if (((1.0 - Ci) > -1.0e-12) and ((1.0 - Ci) <= 0)) {
+        denominator = -1.0e-12;
     }
-    DC = C * DC;
-    return DC;
+
+    if ((DCi < 1.0e-12) and (DCi >= 0)) {
+        numerator = 1.0e-12;
+    } else if ((DCi > -1.0e-12) and (DCi <= 0)) {
+        numerator = -1.0e-12;
+    }
+    return numerator / denominator;
 }
 } // namespace detail
 
@@ -105,9 +120,72 @@ Cavity::Cavity(const std::vector<mrcpp::Coord<3>> &coords, const std::vector<dou
     // compute the radii
     for (auto i = 0; i < this->radii_0.size(); ++i) { this->radii.push_back(this->radii_0[i] * this->alphas[i] + this->betas[i] * this->sigmas[i]); }
 
-    auto p_gradcavity = [&cs = this->centers, &rs = this->radii, &ws = this->sigmas](const mrcpp::Coord<3> &r, int index) { return detail::gradCavity(r, index, cs, rs, ws); };
+    setupNeighbourList();
+
     for (auto i = 0; i < 3; i++) {
-        this->gradvector.push_back([i, p_gradcavity](const mrcpp::Coord<3> &r) -> double { return p_gradcavity(r, i); });
+        this->gradvector.push_back([i, this](const mrcpp::Coord<3> &r) -> double { return this->evalGradient(r, i); });
+    }
+}
+
+/** @brief Sorts the spheres into a uniform grid of cells
+ *  @details The cell size equals the largest sphere reach, so all spheres that can affect a
+ *  point are found in the cell of the point and its nearest neighbours.
+ */
+void Cavity::setupNeighbourList() {
+    this->reach.clear();
+    this->cells.clear();
+    if (this->centers.size() == 0) return;
+
+    mrcpp::Coord<3> r_min = this->centers[0];
+    mrcpp::Coord<3> r_max = this->centers[0];
+    for (auto i = 0; i < this->centers.size(); i++) {
+        this->reach.push_back(this->radii[i] + screen_width * this->sigmas[i]);
+        this->cell_size = std::max(this->cell_size, this->reach[i]);
+        for (int d = 0; d < 3; d++) r_min[d] = std::min(r_min[d], this->centers[i][d]);
+        for (int d = 0; d < 3; d++) r_max[d] = std::max(r_max[d], this->centers[i][d]);
+    }
+    for (int d = 0; d < 3; d++) {
+        this->cell_origin[d] = r_min[d];
+        this->cell_dims[d] = static_cast<int>(std::floor((r_max[d] - r_min[d]) / this->cell_size)) + 1;
+    }
+    this->cells.resize(this->cell_dims[0] * this->cell_dims[1] * this->cell_dims[2]);
+    for (auto i = 0; i < this->centers.size(); i++) {
+        std::array<int, 3> idx;
+        for (int d = 0; d < 3; d++) {
+            idx[d] = static_cast<int>((this->centers[i][d] - r_min[d]) / this->cell_size);
+            idx[d] = std::min(idx[d], this->cell_dims[d] - 1);
+        }
+        this->cells[(idx[0] * this->cell_dims[1] + idx[1]) * this->cell_dims[2] + idx[2]].push_back(i);
+    }
+}
+
+/** @brief Collects the spheres that reach into the box [lo, hi] */
+void Cavity::getNeighbours(const mrcpp::Coord<3> &lo, const mrcpp::Coord<3> &hi, std::vector<int> &spheres) const {
+    spheres.clear();
+    if (this->cells.size() == 0) return;
+
+    std::array<int, 3> c_lo, c_hi;
+    for (int d = 0; d < 3; d++) {
+        c_lo[d] = static_cast<int>(std::floor((lo[d] - this->cell_origin[d]) / this->cell_size)) - 1;
+        c_hi[d] = static_cast<int>(std::floor((hi[d] - this->cell_origin[d]) / this->cell_size)) + 1;
+        if (c_hi[d] < 0 or c_lo[d] >= this->cell_dims[d]) return;
+        c_lo[d] = std::max(c_lo[d], 0);
+        c_hi[d] = std::min(c_hi[d], this->cell_dims[d] - 1);
+    }
+    for (int i = c_lo[0]; i <= c_hi[0]; i++) {
+        for (int j = c_lo[1]; j <= c_hi[1]; j++) {
+            for (int k = c_lo[2]; k <= c_hi[2]; k++) {
+                for (auto n : this->cells[(i * this->cell_dims[1] + j) * this->cell_dims[2] + k]) {
+                    // distance from sphere center to the box
+                    double dist2 = 0.0;
+                    for (int d = 0; d < 3; d++) {
+                        double dr = std::max({lo[d] - this->centers[n][d], 0.0, this->centers[n][d] - hi[d]});
+                        dist2 += dr * dr;
+                    }
+                    if (dist2 < this->reach[n] * this->reach[n]) spheres.push_back(n);
+                }
+            }
+        }
     }
 }
 
@@ -116,8 +194,11 @@ Cavity::Cavity(const std::vector<mrcpp::Coord<3>> &coords, const std::vector<dou
  *  @return double value of the Cavity at point \f$\mathbf{r}\f$
  */
 double Cavity::evalf(const mrcpp::Coord<3> &r) const {
+    thread_local std::vector<int> spheres;
+    getNeighbours(r, r, spheres);
+
     auto C = 1.0;
-    for (int i = 0; i < centers.size(); i++) {
+    for (auto i : spheres) {
         auto center = this->centers[i];
         auto radius = this->radii[i];
         auto sigma = this->sigmas[i];
@@ -131,6 +212,104 @@ double Cavity::evalf(const mrcpp::Coord<3> &r) const {
     return C;
 }
 
+/** @details Spheres out of reach have Theta = 1 exactly, and contribute only with the
+ *  1.0e-12 numerical guard of detail::gradCavityTerm(), which is left out here.
+ */
+double Cavity::evalGradient(const mrcpp::Coord<3> &r, int index) const {
+    thread_local std::vector<int> spheres;
+    getNeighbours(r, r, spheres);
+
+    auto C = 1.0;
+    auto DC = 0.0;
+    for (auto i : spheres) {
+        auto center = this->centers[i];
+        auto dist = math_utils::calc_distance(center, r);
+        auto s = dist - this->radii[i];
+        auto ds = (r[index] - center[index]) / dist;
+        auto Theta = 1.0;
+        DC += detail::gradCavityTerm(s, this->sigmas[i], ds, Theta);
+        C *= Theta;
+    }
+    return C * DC;
+}
+
+void Cavity::evalBlock(const std::vector<mrcpp::Coord<3>> &points, std::vector<double> &values) const {
+    int nPts = points.size();
+    values.assign(nPts, 1.0);
+    if (nPts == 0) return;
+
+    mrcpp::Coord<3> lo = points[0];
+    mrcpp::Coord<3> hi = points[0];
+    std::vector<double> x(nPts), y(nPts), z(nPts), s(nPts);
+    for (int p = 0; p < nPts; p++) {
+        x[p] = points[p][0];
+        y[p] = points[p][1];
+        z[p] = points[p][2];
+        for (int d = 0; d < 3; d++) lo[d] = std::min(lo[d], points[p][d]);
+        for (int d = 0; d < 3; d++) hi[d] = std::max(hi[d], points[p][d]);
+    }
+    std::vector<int> spheres;
+    getNeighbours(lo, hi, spheres);
+
+    for (auto i : spheres) {
+        const auto &c = this->centers[i];
+        const double R = this->radii[i];
+        const double inv_sigma = 1.0 / this->sigmas[i];
+#pragma omp simd
+        for (int p = 0; p < nPts; p++) {
+            double dist = std::sqrt((x[p] - c[0]) * (x[p] - c[0]) + (y[p] - c[1]) * (y[p] - c[1]) + (z[p] - c[2]) * (z[p] - c[2]));
+            s[p] = (dist - R) * inv_sigma;
+        }
+#pragma omp simd
+        for (int p = 0; p < nPts; p++) values[p] *= 0.5 * (1.0 + std::erf(s[p]));
+    }
+    for (int p = 0; p < nPts; p++) values[p] = 1.0 - values[p];
+}
+
+void Cavity::evalGradientBlock(const std::vector<mrcpp::Coord<3>> &points, int index, std::vector<double> &values) const {
+    int nPts = points.size();
+    values.assign(nPts, 0.0);
+    if (nPts == 0) return;
+
+    mrcpp::Coord<3> lo = points[0];
+    mrcpp::Coord<3> hi = points[0];
+    std::vector<double> x(nPts), y(nPts), z(nPts), C(nPts, 1.0);
+    for (int p = 0; p < nPts; p++) {
+        x[p] = points[p][0];
+        y[p] = points[p][1];
+        z[p] = points[p][2];
+        for (int d = 0; d < 3; d++) lo[d] = std::min(lo[d], points[p][d]);
+        for (int d = 0; d < 3; d++) hi[d] = std::max(hi[d], points[p][d]);
+    }
+    const auto &r_i = (index == 0) ? x : ((index == 1) ? y : z);
+    std::vector<int> spheres;
+    getNeighbours(lo, hi, spheres);
+
+    auto sqrt_pi = std::sqrt(mrcpp::pi);
+    for (auto i : spheres) {
+        const auto &c = this->centers[i];
+        const double R = this->radii[i];
+        const double sigma = this->sigmas[i];
+        const double inv_sigma = 1.0 / sigma;
+        const double pre = -1.0 / (sigma * sqrt_pi);
+#pragma omp simd
+        for (int p = 0; p < nPts; p++) {
+            double dist = std::sqrt((x[p] - c[0]) * (x[p] - c[0]) + (y[p] - c[1]) * (y[p] - c[1]) + (z[p] - c[2]) * (z[p] - c[2]));
+            double s = (dist - R) * inv_sigma;
+            double ds = (r_i[p] - c[index]) / dist;
+            double Theta = 0.5 * (1.0 + std::erf(s));
+            double DCi = pre * std::exp(-s * s) * ds;
+
+            // same guards as in detail::gradCavityTerm()
+            double den = (Theta >= 0.0) ? std::max(Theta, 1.0e-12) : std::min(Theta, -1.0e-12);
+            double num = (DCi >= 0.0) ? std::max(DCi, 1.0e-12) : std::min(DCi, -1.0e-12);
+            values[p] += num / den;
+            C[p] *= Theta;
+        }
+    }
+    for (int p = 0; p < nPts; p++) values[p] *= C[p];
+}
+
 void Cavity::printParameters() const {
     // Collect relevant quantities
     auto coords = this->centers;
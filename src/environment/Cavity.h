@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
 #include <vector>
 
@@ -81,6 +82,25 @@ public:
 
     double evalf(const mrcpp::Coord<3> &r) const override;
 
+    /** @brief Evaluates the gradient of the Cavity at a point, see detail::gradCavity.
+     *  @param r coordinates of a 3D point in space.
+     *  @param index variable of differentiation (0->x, 1->y and 2->z).
+     *  @details Only spheres within reach of the point are included.
+     */
+    double evalGradient(const mrcpp::Coord<3> &r, int index) const;
+
+    /** @brief Evaluates the Cavity for a block of points.
+     *  @param points coordinates of the points.
+     *  @param values output values, one for each point.
+     *  @details The spheres that can contribute to the block are looked up once, and each of them is
+     *  evaluated for all points in a branch free loop over contiguous coordinate arrays, which
+     *  allows the compiler to vectorize the erf/exp calls. Most efficient for spatially compact blocks.
+     */
+    void evalBlock(const std::vector<mrcpp::Coord<3>> &points, std::vector<double> &values) const;
+
+    /** @brief Evaluates one component of the Cavity gradient for a block of points, see evalBlock(). */
+    void evalGradientBlock(const std::vector<mrcpp::Coord<3>> &points, int index, std::vector<double> &values) const;
+
     auto getGradVector() const { return this->gradvector; }
 
     std::vector<mrcpp::Coord<3>> getCoordinates() const { return this->centers; } //!< Returns #centers.
@@ -102,11 +122,22 @@ protected:
     std::vector<mrcpp::Coord<3>> centers;                                    //!< Contains each of the spheres centered on the nuclei of the Molecule.
     std::vector<std::function<double(const mrcpp::Coord<3> &r)>> gradvector; //< Analytical derivatives of the Cavity.
 
+    static constexpr double screen_width = 6.0;                              //!< Sphere reach in units of sigma, erf(6) is 1 to machine precision
+    std::vector<double> reach;                                               //!< Distance from each center beyond which the sphere has no effect.
+    double cell_size{0.0};                                                   //!< Edge length of the cells in the sphere neighbour list.
+    mrcpp::Coord<3> cell_origin{};                                           //!< Lower corner of the cell grid.
+    std::array<int, 3> cell_dims{};                                          //!< Number of cells in each direction.
+    std::vector<std::vector<int>> cells;                                     //!< Sphere indices in each cell.
+
     bool isVisibleAtScale(int scale, int nQuadPts) const override;
     bool isZeroOnInterval(const double *a, const double *b) const override;
+
+    void setupNeighbourList();
+    void getNeighbours(const mrcpp::Coord<3> &lo, const mrcpp::Coord<3> &hi, std::vector<int> &spheres) const;
 };
 
 namespace detail {
 auto gradCavity(const mrcpp::Coord<3> &r, int index, const std::vector<mrcpp::Coord<3>> &centers, const std::vector<double> &radii, const std::vector<double> &width) -> double;
+auto gradCavityTerm(double s, double sigma, double ds, double &theta) -> double;
 } // namespace detail
 } // namespace mrchem
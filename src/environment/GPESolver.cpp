@@ -25,6 +25,8 @@
 
 #include "GPESolver.h"
 
+#include <Eigen/Dense>
+
 #include <MRCPP/MWFunctions>
 #include <MRCPP/MWOperators>
 #include <MRCPP/Printer>
@@ -56,11 +58,18 @@ GPESolver::GPESolver(const Permittivity &e, const Density &rho_nuc, PoissonOpera
         , epsilon(e)
         , rho_nuc(rho_nuc)
         , Vr_n(false)
+        , Vr_nm1(false)
+        , rho_prev(false)
+        , kain(std::make_unique<KAIN>(kain_hist))
+        , eps_inv(false)
         , derivative(D)
         , poisson(P) {}
 
 GPESolver::~GPESolver() {
     this->rho_nuc.free();
+    this->rho_prev.free();
+    this->Vr_nm1.free();
+    GPESolver::clearCache();
     clear();
 }
 
@@ -68,6 +77,34 @@ void GPESolver::clear() {
     this->apply_prec = -1.0;
 }
 
+void GPESolver::setupCache(double prec) {
+    if (this->cache_prec > 0.0 and this->cache_prec <= prec) return;
+    clearCache();
+
+    Timer timer;
+    auto eps_inv_func = mrcpp::AnalyticFunction<3>([this](const mrcpp::Coord<3> &r) { return 1.0 / this->epsilon.evalf(r); });
+    mrcpp::CompFunction<3> eps_inv_tree(false);
+    mrcpp::project(eps_inv_tree, eps_inv_func, prec);
+    this->eps_inv = eps_inv_tree;
+
+    auto C_pin = this->epsilon.getCavity_p();
+    for (int d = 0; d < 3; d++) {
+        mrcpp::AnalyticFunction<3> d_cav(C_pin->getGradVector()[d]);
+        mrcpp::CompFunction<3> d_cav_tree(false);
+        mrcpp::project(d_cav_tree, d_cav, prec);
+        this->d_cavity.push_back(d_cav_tree);
+    }
+    this->cache_prec = prec;
+    print_utils::qmfunction(3, "Project cavity functions", this->eps_inv, timer);
+}
+
+void GPESolver::clearCache() {
+    this->eps_inv.free();
+    for (auto &d_cav : this->d_cavity) d_cav.free();
+    this->d_cavity.clear();
+    this->cache_prec = -1.0;
+}
+
 double GPESolver::setConvergenceThreshold(double prec) {
     // converge_thrs should be in the interval [prec, 1.0]
     this->conv_thrs = prec;
@@ -99,12 +136,12 @@ void GPESolver::computeGamma(mrcpp::CompFunction<3> &potential, mrcpp::CompFunct
     resetComplexFunction(out_gamma);
 
     for (int d = 0; d < 3; d++) {
-        auto C_pin = this->epsilon.getCavity_p();
-        mrcpp::AnalyticFunction<3> d_cav(C_pin->getGradVector()[d]);
         mrcpp::CompFunction<3> cplxfunc_prod;
+        resetComplexFunction(cplxfunc_prod);
 
         mrcpp::FunctionTree<3, double> &Tree = get_func(d_V, d);
-        mrcpp::multiply(cplxfunc_prod, Tree, d_cav, this->apply_prec, 1);
+        mrcpp::copy_grid(cplxfunc_prod.real(), Tree);
+        mrcpp::multiply(this->apply_prec, cplxfunc_prod.real(), 1.0, Tree, this->d_cavity[d].real());
         // add result into out_gamma
         if (d == 0) {
             mrcpp::deep_copy(out_gamma, cplxfunc_prod);
@@ -125,11 +162,10 @@ mrcpp::CompFunction<3> GPESolver::solvePoissonEquation(const mrcpp::CompFunction
     Vr_np1.func_ptr->isreal = 1;
     Vr_np1.alloc(1);
 
-    auto eps_inv_func = mrcpp::AnalyticFunction<3>([this](const mrcpp::Coord<3> &r) { return 1.0 / this->epsilon.evalf(r); });
     Density rho_tot(false);
     computeDensities(rho_el, rho_tot);
 
-    mrcpp::multiply(first_term, rho_tot, eps_inv_func, this->apply_prec);
+    mrcpp::multiply(first_term, rho_tot, this->eps_inv, this->apply_prec);
 
     mrcpp::add(rho_eff, 1.0, first_term, -1.0, rho_tot, -1.0);
     rho_tot.free();
@@ -158,8 +194,41 @@ void GPESolver::accelerateConvergence(mrcpp::CompFunction<3> &dfunc, mrcpp::Comp
     dPhi_n.clear();
 }
 
+void GPESolver::updateHistory(const Density &rho_tot) {
+    this->history_reset = true;
+    if (this->rho_prev.Ncomp() > 0) {
+        Density delta_rho(false);
+        mrcpp::add(delta_rho, 1.0, rho_tot, -1.0, this->rho_prev, -1.0);
+        auto rel_change = delta_rho.norm() / rho_tot.norm();
+        delta_rho.free();
+        mrcpp::print::value(3, "Density change", rel_change, "(rel)", 5);
+        this->history_reset = (rel_change > this->history_thrs);
+    }
+    if (this->history_reset) {
+        this->kain->clear();
+        this->Vr_nm1.free();
+    }
+    this->rho_prev.free();
+    mrcpp::deep_copy(this->rho_prev, rho_tot);
+}
+
+void GPESolver::extrapolatePotential() {
+    mrcpp::CompFunction<3> Vr_guess;
+    if (not this->history_reset and this->Vr_nm1.Ncomp() > 0) {
+        mrcpp::add(Vr_guess, 2.0, this->Vr_n, -1.0, this->Vr_nm1, this->apply_prec);
+    } else {
+        mrcpp::deep_copy(Vr_guess, this->Vr_n);
+    }
+    this->Vr_nm1.free();
+    mrcpp::deep_copy(this->Vr_nm1, this->Vr_n);
+
+    resetComplexFunction(this->Vr_n);
+    mrcpp::deep_copy(this->Vr_n, Vr_guess);
+    Vr_guess.free();
+}
+
 void GPESolver::runMicroIterations(const mrcpp::CompFunction<3> &V_vac, const Density &rho_el) {
-    KAIN kain(this->history);
+    auto &kain = *this->kain;
     kain.setLocalPrintLevel(10);
 
     mrcpp::print::separator(3, '-');
@@ -183,7 +252,8 @@ void GPESolver::runMicroIterations(const mrcpp::CompFunction<3> &V_vac, const De
         mrcpp::add(dVr_n, 1.0, Vr_np1, -1.0, this->Vr_n, -1.0);
         update = dVr_n.norm();
 
-        if (iter > 1 and this->history > 0) {
+        // the history of previous SCF cycles can be used already in the first iteration
+        if ((iter > 1 or not this->history_reset) and this->history > 0) {
             accelerateConvergence(dVr_n, Vr_n, kain);
             Vr_np1.free();
             mrcpp::add(Vr_np1, 1.0, Vr_n, 1.0, dVr_n, -1.0);
@@ -203,8 +273,132 @@ void GPESolver::runMicroIterations(const mrcpp::CompFunction<3> &V_vac, const De
 
     if (iter > max_iter) println(0, "Reaction potential failed to converge after " << iter - 1 << " iterations, residual " << update);
     mrcpp::print::separator(3, '-');
+}
+
+void GPESolver::applyJacobian(const mrcpp::CompFunction<3> &jac_term, mrcpp::CompFunction<3> &dV, mrcpp::CompFunction<3> &out) {
+    mrcpp::CompFunction<3> source;
+    GPESolver::computeGamma(dV, source); // surface charge only, the ionic term is added below
+    if (jac_term.Ncomp() > 0) {
+        mrcpp::CompFunction<3> ion_term;
+        mrcpp::multiply(ion_term, jac_term, dV, this->apply_prec);
+        source.add(-1.0, ion_term);
+        ion_term.free();
+    }
+    mrcpp::CompFunction<3> P_source;
+    P_source.func_ptr->isreal = 1;
+    P_source.alloc(1);
+    mrcpp::apply(this->apply_prec, P_source.real(), *poisson, source.real());
+    source.free();
+
+    mrcpp::add(out, 1.0, dV, -1.0, P_source, -1.0);
+    P_source.free();
+}
+
+int GPESolver::solveNewtonStep(const mrcpp::CompFunction<3> &jac_term, mrcpp::CompFunction<3> &residual, mrcpp::CompFunction<3> &delta) {
+    auto beta = residual.norm();
+    int m = std::max(this->max_krylov, 1);
+
+    // Arnoldi basis of the Krylov subspace and the Hessenberg matrix
+    std::vector<mrcpp::CompFunction<3>> V;
+    DoubleMatrix H = DoubleMatrix::Zero(m + 1, m);
+    DoubleVector y;
+
+    mrcpp::CompFunction<3> v_0;
+    mrcpp::deep_copy(v_0, residual);
+    v_0.rescale(1.0 / beta);
+    V.push_back(v_0);
+
+    int n = 0;
+    while (n < m) {
+        mrcpp::CompFunction<3> w;
+        applyJacobian(jac_term, V[n], w);
+
+        // modified Gram-Schmidt
+        for (int i = 0; i <= n; i++) {
+            H(i, n) = mrcpp::dot(V[i], w).real();
+            w.add(-H(i, n), V[i]);
+        }
+        H(n + 1, n) = w.norm();
+        n++;
+
+        // small least squares problem min|beta*e_1 - H*y|
+        DoubleVector b = DoubleVector::Zero(n + 1);
+        b(0) = beta;
+        DoubleMatrix H_n = H.topLeftCorner(n + 1, n);
+        y = H_n.colPivHouseholderQr().solve(b);
+        auto rel_res = (b - H_n * y).norm() / beta;
+
+        if (rel_res < this->newton_forcing or H(n, n - 1) < mrcpp::MachineZero or n == m) {
+            w.free();
+            break;
+        }
+        w.rescale(1.0 / H(n, n - 1));
+        V.push_back(w);
+    }
+
+    std::vector<ComplexDouble> coefs(n);
+    std::vector<mrcpp::CompFunction<3>> funcs(V.begin(), V.begin() + n);
+    for (int i = 0; i < n; i++) coefs[i] = {y(i), 0.0};
+    delta = residual.paramCopy(true);
+    mrcpp::linear_combination(delta, coefs, funcs, this->apply_prec);
+
+    for (auto &v_i : V) v_i.free();
+    return n;
+}
+
+void GPESolver::runNewtonIterations(const mrcpp::CompFunction<3> &V_vac, const Density &rho_el) {
+    Timer t_tot;
+    mrcpp::print::separator(3, '-');
+    auto update = 10.0, norm = 1.0;
+    auto n_krylov = 0;
+
+    auto iter = 1;
+    while (iter <= max_iter) {
+        Timer t_iter;
+        mrcpp::CompFunction<3> V_tot;
+        mrcpp::CompFunction<3> gamma_n;
+        mrcpp::CompFunction<3> residual;
+
+        // residual of the fixed-point map
+        mrcpp::add(V_tot, 1.0, this->Vr_n, 1.0, V_vac, -1.0);
+        computeGamma(V_tot, gamma_n);
+        auto Vr_np1 = solvePoissonEquation(gamma_n, rho_el);
+        gamma_n.free();
+        norm = Vr_np1.norm();
 
-    kain.clear();
+        mrcpp::add(residual, 1.0, Vr_np1, -1.0, this->Vr_n, -1.0);
+        Vr_np1.free();
+        update = residual.norm();
+
+        if (update < this->conv_thrs) {
+            printConvergenceRow(iter, norm, update, t_iter.elapsed());
+            V_tot.free();
+            residual.free();
+            break;
+        }
+
+        // linearize around the current potential and take a Newton step
+        mrcpp::CompFunction<3> jac_term;
+        mrcpp::CompFunction<3> delta;
+        computeJacobianTerm(V_tot, jac_term);
+        n_krylov += solveNewtonStep(jac_term, residual, delta);
+        jac_term.free();
+        V_tot.free();
+        residual.free();
+
+        this->Vr_n.add(1.0, delta);
+        delta.free();
+
+        printConvergenceRow(iter, norm, update, t_iter.elapsed());
+        iter++;
+    }
+
+    if (iter > max_iter) println(0, "Reaction potential failed to converge after " << iter - 1 << " iterations, residual " << update);
+    mrcpp::print::separator(3, '-');
+    mrcpp::print::value(3, "Newton iterations", iter - 1, "", 0, false);
+    mrcpp::print::value(3, "Krylov iterations", n_krylov, "", 0, false);
+    mrcpp::print::time(3, "Newton-Krylov solver", t_tot);
+    mrcpp::print::separator(3, '-');
 }
 
 void GPESolver::printConvergenceRow(int i, double norm, double update, double time) const {
@@ -233,6 +427,7 @@ void GPESolver::printConvergenceRow(int i, double norm, double update, double ti
 
 mrcpp::CompFunction<3> &GPESolver::solveEquation(double prec, const Density &rho_el) {
     this->apply_prec = prec;
+    setupCache(prec);
     Density rho_tot(false);
     computeDensities(rho_el, rho_tot);
     Timer t_vac;
@@ -240,6 +435,7 @@ mrcpp::CompFunction<3> &GPESolver::solveEquation(double prec, const Density &rho
     V_vac.func_ptr->isreal = 1;
     V_vac.alloc(1);
     mrcpp::apply(this->apply_prec, V_vac.real(), *poisson, rho_tot.real());
+    updateHistory(rho_tot);
     rho_tot.free();
     print_utils::qmfunction(3, "Vacuum potential", V_vac, t_vac);
 
@@ -254,12 +450,18 @@ mrcpp::CompFunction<3> &GPESolver::solveEquation(double prec, const Density &rho
 
         computeGamma(V_vac, gamma_0);
         this->Vr_n = solvePoissonEquation(gamma_0, rho_el);
+    } else {
+        extrapolatePotential();
     }
 
     // update the potential/gamma before doing anything with them
 
     Timer t_scrf;
-    runMicroIterations(V_vac, rho_el);
+    if (this->newton) {
+        runNewtonIterations(V_vac, rho_el);
+    } else {
+        runMicroIterations(V_vac, rho_el);
+    }
     print_utils::qmfunction(3, "Reaction potential", this->Vr_n, t_scrf);
     return this->Vr_n;
 }
@@ -281,7 +483,8 @@ void GPESolver::printParameters() const {
         {"Method                ", this->solver_name},
         {"Density               ", this->density_type},
         {"Max iterations        ", this->max_iter},
-        {"KAIN solver           ", (this->history > 0) ? std::to_string(this->history) : "Off"},
+        {"Micro-iterations      ", (this->newton) ? "Newton-Krylov" : "Fixed-point"},
+        {"KAIN solver           ", (this->history > 0 and not this->newton) ? std::to_string(this->history) : "Off"},
         {"Dynamic threshold     ", (this->dynamic_thrs) ? "On" : "Off"},
     };
 
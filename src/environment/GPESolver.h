@@ -76,7 +76,7 @@ public:
               int max_iter,
               bool dyn_thrs,
               SCRFDensityType density_type);
-    ~GPESolver();
+    virtual ~GPESolver();
 
     /** @brief Sets the convergence threshold for the micro-iterations, used with dynamic thresholding.
      *  @param prec value to set the convergence threshold to
@@ -90,6 +90,9 @@ public:
 
     void updateMOResidual(double const err_t) { this->mo_residual = err_t; }
 
+    /** @brief Selects the Newton-Krylov micro-iterations (#runNewtonIterations) instead of the accelerated fixed-point iterations */
+    void setNewtonSolver(bool use_newton) { this->newton = use_newton; }
+
     /** @brief Computes the energy contributions from the reaction potential
      * @param rho_el the electronic charge density
      * @return a tuple containing the electronic and nuclear energy contributions
@@ -110,6 +113,7 @@ public:
 
 protected:
     bool dynamic_thrs;
+    bool newton{false}; //!< Use Newton-Krylov micro-iterations, see #runNewtonIterations
     SCRFDensityType density_type; //!< Decides which density we will use for computing the reaction potential, options are ``total``, ``electronic`` and ``nuclear``.
 
     int max_iter;
@@ -130,12 +134,37 @@ protected:
     // maybe after applying the Poisson operator?
 
     mrcpp::CompFunction<3> Vr_n;
+    mrcpp::CompFunction<3> Vr_nm1; //!< Converged reaction potential of the previous SCF cycle, used for extrapolation
+    Density rho_prev;              //!< Density of the previous SCF cycle, used to decide if the history is kept
+
+    double history_thrs{1.0e-2}; //!< Relative density change above which the micro-iteration history is discarded
+    bool history_reset{true};    //!< Whether the history was discarded in the current SCF cycle
+    std::unique_ptr<KAIN> kain;  //!< Accelerator of the micro-iterations, kept between SCF cycles
+
+    int max_krylov{10};         //!< Max dimension of the Krylov subspace in each Newton step
+    double newton_forcing{0.1}; //!< Relative residual to which each Newton step is solved
+
+    double cache_prec{-1.0};                      //!< Precision of the projected cavity functions, negative if not projected
+    mrcpp::CompFunction<3> eps_inv;               //!< Projected inverse permittivity \f$1/\epsilon(\mathbf{r})\f$
+    std::vector<mrcpp::CompFunction<3>> d_cavity; //!< Projected cavity gradient \f$\nabla C(\mathbf{r})\f$
 
     std::shared_ptr<mrcpp::DerivativeOperator<3>> derivative;
     std::shared_ptr<mrcpp::PoissonOperator> poisson;
 
     void clear();
 
+    /** @brief Projects the fixed cavity dependent functions onto function trees
+     * @param prec the projection precision
+     * @details The cavity does not change during the SCF, so the inverse permittivity and the cavity gradient
+     * are projected once and reused in all micro-iterations and SCF cycles, instead of evaluating the analytic
+     * functions (which sum over all cavity spheres in each point) every time. The projection is only redone
+     * if a tighter precision than the cached one is requested.
+     */
+    virtual void setupCache(double prec);
+
+    /** @brief Frees the projected cavity dependent functions */
+    virtual void clearCache();
+
     /** @brief computes density wrt. the density_type variable
      * @param Phi the molecular orbitals
      * @param rho_out Density function in which the density will be computed.
@@ -181,6 +210,19 @@ protected:
      */
     void accelerateConvergence(mrcpp::CompFunction<3> &dfunc, mrcpp::CompFunction<3> &func, KAIN &kain);
 
+    /** @brief Decides if the micro-iteration history can be kept for the current SCF cycle
+     * @param rho_tot the charge density of the current SCF cycle
+     * @details The KAIN history and the previous reaction potentials are kept as long as the relative change
+     * of the density since the previous SCF cycle is below #history_thrs, and discarded otherwise.
+     */
+    void updateHistory(const Density &rho_tot);
+
+    /** @brief Extrapolates the starting reaction potential from the last two converged ones
+     * @details The starting guess is \f$V_R^{n} = 2V_R^{n-1} - V_R^{n-2}\f$ if the history was kept, and the
+     * previous converged potential \f$V_R^{n-1}\f$ otherwise.
+     */
+    void extrapolatePotential();
+
     /** @brief Iterates through the application of the Poisson operator to Solve the Generalized Poisson equation
      *  @param V_vac the vacuum potential
      *  @param Phi_p the molecular orbitals
@@ -194,9 +236,46 @@ protected:
      *  -# Accelerate convergence of the reaction potential through KAIN
      *  -# Update the reaction potential as \f$V_R(\mathbf{r}) = V_R^{old}(\mathbf{r}) + \Delta V_R(\mathbf{r})\f$
      *  -# Check if the reaction potential has converged, if not, repeat from step 1.
+     *
+     * The KAIN history is kept between SCF cycles, see #updateHistory.
      */
     void runMicroIterations(const mrcpp::CompFunction<3> &V_vac, const Density &rho_el);
 
+    /** @brief Computes the derivative of the ionic charge term wrt. the potential
+     * @param V_tot the total potential to linearize around
+     * @param jac_term output, the function multiplying the potential update in the Jacobian
+     * @details There is no ionic charge in the Generalized Poisson equation, and jac_term is left empty.
+     */
+    virtual void computeJacobianTerm(mrcpp::CompFunction<3> &V_tot, mrcpp::CompFunction<3> &jac_term) {}
+
+    /** @brief Applies the Jacobian of the micro-iteration residual to a potential update
+     * @param jac_term the ionic charge term from #computeJacobianTerm
+     * @param dV the potential update
+     * @param out output, \f$\delta V - \mathcal{P} \star \left[ \gamma_s[\delta V] - J_{ion} \delta V \right]\f$
+     * @details The surface charge is linear in the potential, so its derivative is the surface charge of the update itself.
+     */
+    void applyJacobian(const mrcpp::CompFunction<3> &jac_term, mrcpp::CompFunction<3> &dV, mrcpp::CompFunction<3> &out);
+
+    /** @brief Solves the linearized micro-iteration equation with GMRES
+     * @param jac_term the ionic charge term from #computeJacobianTerm
+     * @param residual the current residual \f$F(V_R) - V_R\f$
+     * @param delta output, the Newton step
+     * @return the number of Krylov iterations (Poisson operator applications)
+     * @details The Poisson operator inside the fixed-point map acts as preconditioner, so the Krylov subspace
+     * converges in few iterations. The step is solved inexactly, to a relative residual of #newton_forcing.
+     */
+    int solveNewtonStep(const mrcpp::CompFunction<3> &jac_term, mrcpp::CompFunction<3> &residual, mrcpp::CompFunction<3> &delta);
+
+    /** @brief Converges the reaction potential with an inexact Newton-Krylov method
+     *  @param V_vac the vacuum potential
+     *  @param rho_el the electronic density
+     * @details The fixed-point map \f$F(V_R)\f$ of #runMicroIterations is solved as the root problem \f$F(V_R) - V_R = 0\f$.
+     * Each Newton step linearizes the ionic charge term around the current total potential (\f$\kappa^2\cosh(V_{tot})\f$
+     * for the Poisson-Boltzmann equation) and solves the linear equation with #solveNewtonStep.
+     * The convergence criterion is the same as for the fixed-point iterations.
+     */
+    void runNewtonIterations(const mrcpp::CompFunction<3> &V_vac, const Density &rho_el);
+
     /** @brief Setups and computes the reaction potential through the microiterations
      * @param V_vac the vacuum potential
      * @param Phi_p the molecular orbitals
@@ -207,7 +286,7 @@ protected:
      * -# Iterate once through the application of the Poisson operator to return the initial guess of the reaction potential \f$V_R(\mathbf{r})\f$
      *
      * the method then runs the micro-iterations through #runMicroIterations and returns the converged reaction potential.
-     * If this is not the first SCF iteration, the previous converged reaction potential is used as an initial guess for the micro-iterations.
+     * If this is not the first SCF iteration, the previous converged reaction potentials are extrapolated to an initial guess for the micro-iterations.
      */
     mrcpp::CompFunction<3> &solveEquation(double prec, const Density &rho_el);
 
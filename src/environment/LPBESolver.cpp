@@ -58,8 +58,15 @@ LPBESolver::LPBESolver(const Permittivity &e,
 // TODO separate this for the linear and non-linear solver
 void LPBESolver::computePBTerm(mrcpp::CompFunction<3> &V_tot, const double salt_factor, mrcpp::CompFunction<3> &pb_term) {
     resetComplexFunction(pb_term);
-    mrcpp::multiply(pb_term, V_tot, this->kappa, this->apply_prec);
+    mrcpp::multiply(pb_term, V_tot, this->kappa_tree, this->apply_prec);
     pb_term.rescale(salt_factor / (4.0 * mrcpp::pi));
 }
 
+void LPBESolver::computeJacobianTerm(mrcpp::CompFunction<3> &V_tot, mrcpp::CompFunction<3> &jac_term) {
+    auto salt_factor = 1.0; // same as in computeGamma
+    resetComplexFunction(jac_term);
+    mrcpp::deep_copy(jac_term, this->kappa_tree);
+    jac_term.rescale(salt_factor / (4.0 * mrcpp::pi));
+}
+
 } // namespace mrchem
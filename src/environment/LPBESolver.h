@@ -65,6 +65,9 @@ protected:
      * @details The PB term is computed as \f$ \kappa^2 V_{tot} \f$ and returned.
      */
     void computePBTerm(mrcpp::CompFunction<3> &V_tot, const double salt_factor, mrcpp::CompFunction<3> &pb_term) override;
+
+    /** @brief Computes the derivative of the PB term, \f$ \kappa^2 \f$, which does not depend on the potential */
+    void computeJacobianTerm(mrcpp::CompFunction<3> &V_tot, mrcpp::CompFunction<3> &jac_term) override;
     std::string solver_name{"Linearized Poisson-Boltzmann"};
 };
 } // namespace mrchem
@@ -55,7 +55,29 @@ PBESolver::PBESolver(const Permittivity &e,
                      bool dyn_thrs,
                      SCRFDensityType density_type)
         : GPESolver(e, rho_nuc, P, D, kain_hist, max_iter, dyn_thrs, density_type)
-        , kappa(k) {}
+        , kappa(k)
+        , kappa_tree(false) {}
+
+PBESolver::~PBESolver() {
+    this->kappa_tree.free();
+}
+
+void PBESolver::setupCache(double prec) {
+    bool update = (this->cache_prec < 0.0 or this->cache_prec > prec);
+    GPESolver::setupCache(prec);
+    if (not update) return;
+
+    Timer timer;
+    mrcpp::CompFunction<3> kappa_proj(false);
+    mrcpp::project(kappa_proj, this->kappa, prec);
+    this->kappa_tree = kappa_proj;
+    print_utils::qmfunction(3, "Project DH screening", this->kappa_tree, timer);
+}
+
+void PBESolver::clearCache() {
+    GPESolver::clearCache();
+    this->kappa_tree.free();
+}
 
 void PBESolver::computePBTerm(mrcpp::CompFunction<3> &V_tot, const double salt_factor, mrcpp::CompFunction<3> &pb_term) {
     // create a lambda function for the sinh(V) term and multiply it with kappa and salt factor to get the PB term
@@ -66,7 +88,20 @@ void PBESolver::computePBTerm(mrcpp::CompFunction<3> &V_tot, const double salt_f
     sinhV.alloc(1);
     mrcpp::map(this->apply_prec / 100, sinhV.real(), V_tot.real(), sinh_f);
 
-    mrcpp::multiply(pb_term, sinhV, this->kappa, this->apply_prec);
+    mrcpp::multiply(pb_term, sinhV, this->kappa_tree, this->apply_prec);
+}
+
+void PBESolver::computeJacobianTerm(mrcpp::CompFunction<3> &V_tot, mrcpp::CompFunction<3> &jac_term) {
+    auto salt_factor = 1.0; // same as in computeGamma
+    auto cosh_f = [salt_factor](const double &V) { return (salt_factor / (4.0 * mrcpp::pi)) * std::cosh(V); };
+    resetComplexFunction(jac_term);
+    mrcpp::CompFunction<3> coshV;
+    coshV.func_ptr->isreal = 1;
+    coshV.alloc(1);
+    mrcpp::map(this->apply_prec / 100, coshV.real(), V_tot.real(), cosh_f);
+
+    mrcpp::multiply(jac_term, coshV, this->kappa_tree, this->apply_prec);
+    coshV.free();
 }
 
 void PBESolver::computeGamma(mrcpp::CompFunction<3> &potential, mrcpp::CompFunction<3> &out_gamma) {
@@ -75,11 +110,11 @@ void PBESolver::computeGamma(mrcpp::CompFunction<3> &potential, mrcpp::CompFunct
     resetComplexFunction(out_gamma);
 
     for (int d = 0; d < 3; d++) {
-        auto C_pin = this->epsilon.getCavity_p();
-        mrcpp::AnalyticFunction<3> d_cav(C_pin->getGradVector()[d]);
         mrcpp::CompFunction<3> cplxfunc_prod;
+        resetComplexFunction(cplxfunc_prod);
         mrcpp::FunctionTree<3, double> &Tree = get_func(d_V, d);
-        mrcpp::multiply(cplxfunc_prod, Tree, d_cav, this->apply_prec, 1);
+        mrcpp::copy_grid(cplxfunc_prod.real(), Tree);
+        mrcpp::multiply(this->apply_prec, cplxfunc_prod.real(), 1.0, Tree, this->d_cavity[d].real());
         // add result into out_gamma
         if (d == 0) {
             mrcpp::deep_copy(out_gamma, cplxfunc_prod);
@@ -70,10 +70,13 @@ public:
               bool dyn_thrs,
               SCRFDensityType density_type);
 
+    ~PBESolver() override;
+
     friend class ReactionPotential;
 
 protected:
-    DHScreening kappa; ///< the DHScreening object used to compute the PB term \f$\kappa\f$
+    DHScreening kappa;                 ///< the DHScreening object used to compute the PB term \f$\kappa\f$
+    mrcpp::CompFunction<3> kappa_tree; ///< Projected DHScreening function, see setupCache()
     std::string solver_name{"Poisson-Boltzmann"};
 
     /** @brief constructs the surface chage distribution and adds it to the PB term
@@ -83,6 +86,10 @@ protected:
      */
     void computeGamma(mrcpp::CompFunction<3> &potential, mrcpp::CompFunction<3> &out_gamma) override;
 
+    /** @brief Projects the cavity dependent functions, including the DHScreening function, see GPESolver::setupCache */
+    void setupCache(double prec) override;
+    void clearCache() override;
+
     /** @brief Computes the PB term
      * @param[in] V_tot the total potential
      * @param[in] salt_factor the salt factor deciding how much of the total concentration to include in the PB term
@@ -90,5 +97,12 @@ protected:
      * @details The PB term is computed as \f$ \kappa^2 \sinh(V_{tot}) \f$ and returned.
      */
     virtual void computePBTerm(mrcpp::CompFunction<3> &V_tot, const double salt_factor, mrcpp::CompFunction<3> &pb_term);
+
+    /** @brief Computes the derivative of the PB term wrt. the total potential
+     * @param[in] V_tot the total potential to linearize around
+     * @param[out] jac_term the CompFunction<3> in which to store the result
+     * @details The derivative is \f$ \kappa^2 \cosh(V_{tot}) \f$, used in the Newton-Krylov micro-iterations.
+     */
+    void computeJacobianTerm(mrcpp::CompFunction<3> &V_tot, mrcpp::CompFunction<3> &jac_term) override;
 };
 } // namespace mrchem
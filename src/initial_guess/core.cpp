@@ -23,6 +23,10 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <algorithm>
+#include <array>
+#include <tuple>
+
 #include <MRCPP/MWOperators>
 #include <MRCPP/Parallel>
 #include <MRCPP/Printer>
@@ -32,6 +36,7 @@
 
 #include "analyticfunctions/HydrogenFunction.h"
 #include "chemistry/Nucleus.h"
+#include "chemistry/PhysicalConstants.h"
 
 #include "utils/math_utils.h"
 #include "utils/print_utils.h"
@@ -181,11 +186,11 @@ void initial_guess::core::project_ao(OrbitalVector &Phi, double prec, const Nucl
 
     const char label[10] = "spdfg";
 
+    // Collect the AO quantum numbers, the orbitals are distributed by their rank
+    std::vector<std::array<int, 4>> ao_funcs; // (nucleus, n, l, m)
     for (int i = 0; i < nucs.size(); i++) {
         const Nucleus &nuc = nucs[i];
         int minAO = std::ceil(nuc.getElement().getZ() / 2.0);
-        double Z = nuc.getCharge();
-        const mrcpp::Coord<3> &R = nuc.getCoord();
 
         int nAO = 0;
         int nShell = 0;
@@ -200,26 +205,41 @@ void initial_guess::core::project_ao(OrbitalVector &Phi, double prec, const Nucl
             if (zetaReached >= zeta) break;
 
             for (int m = 0; m < M; m++) {
-                Timer t_i;
-                HydrogenFunction h_func(n, l, m, Z, R);
                 Phi.push_back(Orbital(SPIN::Paired));
                 Phi.back().setRank(Phi.size() - 1);
-                if (mrcpp::mpi::my_func(Phi.back())) {
-                    mrcpp::project(Phi.back(), h_func, prec);
-                    if (std::abs(Phi.back().norm() - 1.0) > 0.01) MSG_WARN("AO not normalized!");
-                }
-
-                std::stringstream o_txt;
-                o_txt << std::setw(w1 - 1) << Phi.size() - 1;
-                o_txt << std::setw(w4) << nuc.getElement().getSymbol();
-                o_txt << std::setw(w2 - 1) << n << label[l];
-                print_utils::qmfunction(2, o_txt.str(), Phi.back(), t_i);
-
+                ao_funcs.push_back({i, n, l, m});
                 if (++nAO >= minAO) minAOReached = true;
             }
             nShell++;
         }
     }
+
+    // Project the local AOs concurrently
+    auto first = Phi.size() - ao_funcs.size();
+    std::vector<Timer> t_aos(ao_funcs.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int j = 0; j < ao_funcs.size(); j++) {
+        t_aos[j].start();
+        auto &phi_j = Phi[first + j];
+        if (mrcpp::mpi::my_func(phi_j)) {
+            const auto [i, n, l, m] = ao_funcs[j];
+            HydrogenFunction h_func(n, l, m, nucs[i].getCharge(), nucs[i].getCoord());
+            mrcpp::project(phi_j, h_func, prec);
+        }
+        t_aos[j].stop();
+    }
+
+    for (int j = 0; j < ao_funcs.size(); j++) {
+        auto &phi_j = Phi[first + j];
+        if (mrcpp::mpi::my_func(phi_j) and std::abs(phi_j.norm() - 1.0) > 0.01) MSG_WARN("AO not normalized!");
+
+        const auto [i, n, l, m] = ao_funcs[j];
+        std::stringstream o_txt;
+        o_txt << std::setw(w1 - 1) << first + j;
+        o_txt << std::setw(w4) << nucs[i].getElement().getSymbol();
+        o_txt << std::setw(w2 - 1) << n << label[l];
+        print_utils::qmfunction(2, o_txt.str(), phi_j, t_aos[j]);
+    }
     mrcpp::print::footer(2, t_tot, 2);
 }
 
@@ -249,4 +269,147 @@ ComplexMatrix initial_guess::core::diagonalize(OrbitalVector &Phi, MomentumOpera
     return S_m12 * U;
 }
 
+/** @brief Diagonalize a Fock matrix screened by fragment distances
+ *
+ * @param Phi: AO basis, ordered fragment by fragment
+ * @param p: momentum operator
+ * @param V: potential operator
+ * @param frags: nuclei of each fragment
+ * @param frag_sizes: number of AOs in each fragment
+ * @param cutoff: largest nuclear distance for which fragments are coupled
+ *
+ * The overlap and Fock matrices are computed block by block. Blocks between
+ * fragments whose closest nuclei are further apart than the cutoff are set
+ * to zero, since the AOs of such fragments have negligible overlap. For
+ * spatially extended systems the number of computed blocks thus grows
+ * linearly with the number of fragments. The screened matrices are then
+ * Lowdin orthogonalized and diagonalized as in diagonalize(), so the result
+ * can be used with rotate_orbitals() in the same way. The neglected overlaps
+ * leave a small non-orthogonality in the rotated orbitals.
+ */
+ComplexMatrix initial_guess::core::diagonalize_fragments(OrbitalVector &Phi, MomentumOperator &p, RankZeroOperator &V, const std::vector<Nuclei> &frags, const std::vector<int> &frag_sizes, double cutoff) {
+    if (frags.size() != frag_sizes.size()) MSG_ABORT("Size mismatch");
+
+    auto frag_distance = [](const Nuclei &nucs_f, const Nuclei &nucs_g) {
+        double r_min = -1.0;
+        for (const auto &nuc_f : nucs_f) {
+            for (const auto &nuc_g : nucs_g) {
+                auto r_fg = math_utils::calc_distance(nuc_f.getCoord(), nuc_g.getCoord());
+                if (r_min < 0.0 or r_fg < r_min) r_min = r_fg;
+            }
+        }
+        return r_min;
+    };
+
+    Timer t1;
+    int N_frags = frag_sizes.size();
+    std::vector<int> offsets(N_frags, 0);
+    for (int f = 1; f < N_frags; f++) offsets[f] = offsets[f - 1] + frag_sizes[f - 1];
+
+    int N_blocks = 0;
+    ComplexMatrix s_tilde = ComplexMatrix::Zero(Phi.size(), Phi.size());
+    ComplexMatrix f_tilde = ComplexMatrix::Zero(Phi.size(), Phi.size());
+    for (int f = 0; f < N_frags; f++) {
+        OrbitalVector Phi_f = initial_guess::core::extract(Phi, offsets[f], frag_sizes[f]);
+        for (int g = f; g < N_frags; g++) {
+            if (g != f and frag_distance(frags[f], frags[g]) > cutoff) continue;
+            OrbitalVector Phi_g;
+            if (g != f) Phi_g = initial_guess::core::extract(Phi, offsets[g], frag_sizes[g]);
+            OrbitalVector &ket = (g != f) ? Phi_g : Phi_f;
+
+            ComplexMatrix s_fg = orbital::calc_overlap_matrix(Phi_f, ket);
+            ComplexMatrix t_fg = qmoperator::calc_kinetic_matrix(p, Phi_f, ket);
+            ComplexMatrix v_fg = V(Phi_f, ket);
+            ComplexMatrix f_fg = t_fg + v_fg;
+            s_tilde.block(offsets[f], offsets[g], frag_sizes[f], frag_sizes[g]) = s_fg;
+            f_tilde.block(offsets[f], offsets[g], frag_sizes[f], frag_sizes[g]) = f_fg;
+            if (g != f) {
+                s_tilde.block(offsets[g], offsets[f], frag_sizes[g], frag_sizes[f]) = s_fg.adjoint();
+                f_tilde.block(offsets[g], offsets[f], frag_sizes[g], frag_sizes[f]) = f_fg.adjoint();
+            }
+            N_blocks++;
+        }
+    }
+    ComplexMatrix S_m12 = math_utils::hermitian_matrix_pow(s_tilde, -0.5);
+    ComplexMatrix f_mat = S_m12.adjoint() * f_tilde * S_m12;
+    mrcpp::print::separator(2, '-');
+    print_utils::scalar(2, "Fragment blocks", N_blocks, "", 0, false);
+    mrcpp::print::separator(2, '-');
+    mrcpp::print::time(1, "Computing Fock matrix", t1);
+
+    Timer t2;
+    DoubleVector eig;
+    ComplexMatrix U = math_utils::diagonalize_hermitian_matrix(f_mat, eig);
+    mrcpp::print::time(1, "Diagonalizing Fock matrix", t2);
+
+    return S_m12 * U;
+}
+
+/** @brief Extract a contiguous range of orbitals into a new vector
+ *
+ * @param Phi: vector to extract from, unchanged on exit
+ * @param first: index of the first orbital to extract
+ * @param size: number of orbitals to extract
+ *
+ * The orbitals are new copies, ranked by their position in the new vector,
+ * such that the input orbitals keep their rank and data. Orbitals that change
+ * owner in this ranking are sent over MPI, the others are copied locally.
+ */
+OrbitalVector initial_guess::core::extract(OrbitalVector &Phi, int first, int size) {
+    OrbitalVector out;
+    for (int i = first; i < first + size; i++) {
+        int j = out.size();
+        Orbital phi_j;
+        phi_j.func_ptr->data = Phi[i].func_ptr->data;
+        if (i % mrcpp::mpi::wrk_size == j % mrcpp::mpi::wrk_size) {
+            if (mrcpp::mpi::my_func(i)) mrcpp::deep_copy(phi_j, Phi[i]);
+        } else {
+            // need to send orbital from owner to new owner
+            if (mrcpp::mpi::my_func(i)) { mrcpp::mpi::send_function(Phi[i], j % mrcpp::mpi::wrk_size, i, mrcpp::mpi::comm_wrk); }
+            if (mrcpp::mpi::my_func(j)) { mrcpp::mpi::recv_function(phi_j, i % mrcpp::mpi::wrk_size, i, mrcpp::mpi::comm_wrk); }
+        }
+        phi_j.setRank(j);
+        out.push_back(phi_j);
+    }
+    return out;
+}
+
+/** @brief Partition the nuclei into covalently bonded fragments
+ *
+ * @param nucs: the nuclei of the molecule
+ *
+ * Two atoms are considered bonded if their distance is less than 1.2 times
+ * the sum of their covalent radii. The fragments are the connected components
+ * of the resulting bond graph, e.g. the individual molecules of a cluster.
+ */
+std::vector<Nuclei> initial_guess::core::partition_fragments(const Nuclei &nucs) {
+    auto ang2bohr = PhysicalConstants::get("angstrom2bohrs");
+    int N_nucs = nucs.size();
+    int N_frags = 0;
+    std::vector<int> frag_idx(N_nucs, -1);
+    for (int i = 0; i < N_nucs; i++) {
+        if (frag_idx[i] >= 0) continue;
+        frag_idx[i] = N_frags;
+        std::vector<int> stack = {i};
+        while (not stack.empty()) {
+            int a = stack.back();
+            stack.pop_back();
+            for (int b = 0; b < N_nucs; b++) {
+                if (frag_idx[b] >= 0) continue;
+                auto r_ab = math_utils::calc_distance(nucs[a].getCoord(), nucs[b].getCoord());
+                auto r_cov = nucs[a].getElement().getCov() + nucs[b].getElement().getCov();
+                if (r_ab < 1.2 * ang2bohr * r_cov) {
+                    frag_idx[b] = N_frags;
+                    stack.push_back(b);
+                }
+            }
+        }
+        N_frags++;
+    }
+
+    std::vector<Nuclei> frags(N_frags);
+    for (int i = 0; i < N_nucs; i++) frags[frag_idx[i]].push_back(nucs[i]);
+    return frags;
+}
+
 } // namespace mrchem
@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mrchem.h"
 #include "qmfunctions/qmfunction_fwd.h"
 #include "tensor/tensor_fwd.h"
@@ -49,6 +51,9 @@ bool setup(OrbitalVector &Phi, double prec, const Nuclei &nucs, int zeta);
 void project_ao(OrbitalVector &Phi, double prec, const Nuclei &nucs, int zeta);
 void rotate_orbitals(OrbitalVector &Psi, double prec, ComplexMatrix &U, OrbitalVector &Phi);
 ComplexMatrix diagonalize(OrbitalVector &Phi, MomentumOperator &T, RankZeroOperator &V);
+ComplexMatrix diagonalize_fragments(OrbitalVector &Phi, MomentumOperator &T, RankZeroOperator &V, const std::vector<Nuclei> &frags, const std::vector<int> &frag_sizes, double cutoff);
+OrbitalVector extract(OrbitalVector &Phi, int first, int size);
+std::vector<Nuclei> partition_fragments(const Nuclei &nucs);
 
 } // namespace core
 } // namespace initial_guess
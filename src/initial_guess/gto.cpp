@@ -23,7 +23,10 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <limits>
+
 #include <MRCPP/Gaussians>
+#include <MRCPP/MWFunctions>
 #include <MRCPP/Parallel>
 #include <MRCPP/Printer>
 #include <MRCPP/Timer>
@@ -47,6 +50,14 @@ using mrcpp::Timer;
 
 namespace mrchem {
 
+namespace initial_guess {
+namespace gto {
+
+void project_mo_batch(double prec, std::vector<mrcpp::FunctionTree<3> *> &trees, const gto_utils::OrbitalExp &gto_exp, const DoubleMatrix &C, double screen);
+
+} // namespace gto
+} // namespace initial_guess
+
 /** @brief Produce an initial guess of orbitals
  *
  * @param Phi: vector or MW orbitals
@@ -145,18 +156,27 @@ void initial_guess::gto::project_mo(OrbitalVector &Phi, double prec, const std::
     if (MO.cols() < Phi.size()) MSG_ABORT("Size mismatch");
     t2.stop();
 
+    // Project all local MOs together
     Timer t3;
+    std::vector<int> mo_idx;
+    std::vector<mrcpp::FunctionTree<3> *> mo_trees;
+    for (int i = 0; i < Phi.size(); i++) {
+        if (not mrcpp::mpi::my_func(Phi[i])) continue;
+        if (MO.col(i).cwiseAbs().maxCoeff() < mrcpp::MachineZero) MSG_WARN("No contributing orbital");
+        Phi[i].alloc(1);
+        mo_idx.push_back(i);
+        mo_trees.push_back(&Phi[i].real());
+    }
+    DoubleMatrix C = DoubleMatrix::Zero(MO.rows(), mo_idx.size());
+    for (int k = 0; k < mo_idx.size(); k++) C.col(k) = MO.col(mo_idx[k]);
+    initial_guess::gto::project_mo_batch(prec, mo_trees, gto_exp, C, screen);
+    t3.stop();
+
     for (int i = 0; i < Phi.size(); i++) {
-        Timer t_i;
-        if (mrcpp::mpi::my_func(Phi[i])) {
-            GaussExp<3> mo_i = gto_exp.getMO(i, MO.transpose());
-            mo_i.calcScreening(screen);
-            mrcpp::project(prec, Phi[i].real(), mo_i);
-        }
         std::stringstream o_txt;
         o_txt << std::setw(w1 - 1) << i;
         o_txt << std::setw(w3) << print_utils::dbl_to_str(Phi[i].norm(), pprec, true);
-        print_utils::qmfunction(2, o_txt.str(), Phi[i], t_i);
+        print_utils::qmfunction(2, o_txt.str(), Phi[i], t3);
     }
     mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
     mrcpp::print::separator(2, '-');
@@ -166,6 +186,98 @@ void initial_guess::gto::project_mo(OrbitalVector &Phi, double prec, const std::
     mrcpp::print::footer(1, t_tot, 2);
 }
 
+/** @brief Project a batch of GTO MOs on a common adaptive grid
+ *
+ * @param prec: precision used in projection
+ * @param trees: output MO trees, allocated but empty
+ * @param gto_exp: AO basis
+ * @param C: MO coefficients, one column per output tree
+ * @param screen: GTO screening in StdDev
+ *
+ * Instead of projecting each MO as a separate GaussExp, where every AO
+ * primitive is evaluated again for every MO, all MOs share one grid. In each
+ * leaf node the AOs are evaluated once in the quadrature points, skipping AOs
+ * whose screening box does not overlap the node, and the MO values follow from
+ * a single matrix product with the coefficients. The grid starts out as the
+ * union of the AO grids and is refined until no MO has wavelet norms above
+ * the precision.
+ */
+void initial_guess::gto::project_mo_batch(double prec, std::vector<mrcpp::FunctionTree<3> *> &trees, const gto_utils::OrbitalExp &gto_exp, const DoubleMatrix &C, double screen) {
+    int N_ao = gto_exp.size();
+    int N_mo = trees.size();
+    if (N_mo == 0) return;
+    if (C.rows() != N_ao or C.cols() != N_mo) MSG_ABORT("Size mismatch");
+
+    // Screened AOs and their screening boxes
+    std::vector<GaussExp<3>> aos;
+    std::vector<mrcpp::Coord<3>> ao_lo(N_ao), ao_hi(N_ao);
+    GaussExp<3> ao_sum;
+    for (int j = 0; j < N_ao; j++) {
+        aos.push_back(gto_exp.getAO(j));
+        aos[j].calcScreening(screen);
+        ao_sum.append(aos[j]);
+        const auto &R_j = aos[j].getFunc(0).getPos();
+        for (int d = 0; d < 3; d++) {
+            double sigma = 0.0;
+            for (int k = 0; k < aos[j].size(); k++) sigma = std::max(sigma, std::sqrt(1.0 / (2.0 * aos[j].getFunc(k).getExp()[d])));
+            double r_j = (screen > 0.0) ? screen * sigma : std::numeric_limits<double>::max();
+            ao_lo[j][d] = R_j[d] - r_j;
+            ao_hi[j][d] = R_j[d] + r_j;
+        }
+    }
+
+    const auto sf = MRA->getWorldBox().getScalingFactors();
+    mrcpp::FunctionTree<3> grid(*MRA);
+    mrcpp::build_grid(grid, ao_sum);
+
+    while (true) {
+        for (auto *tree : trees) mrcpp::copy_grid(*tree, grid);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int n = 0; n < grid.getNEndNodes(); n++) {
+            Eigen::MatrixXd pts;
+            grid.getEndFuncNode(n).getExpandedChildPts(pts);
+            int N_pts = pts.cols();
+            mrcpp::Coord<3> lo, hi;
+            for (int d = 0; d < 3; d++) {
+                pts.row(d) *= sf[d];
+                lo[d] = pts.row(d).minCoeff();
+                hi[d] = pts.row(d).maxCoeff();
+            }
+
+            std::vector<int> ao_idx;
+            for (int j = 0; j < N_ao; j++) {
+                bool overlap = true;
+                for (int d = 0; d < 3; d++) overlap = overlap and ao_lo[j][d] <= hi[d] and ao_hi[j][d] >= lo[d];
+                if (overlap) ao_idx.push_back(j);
+            }
+
+            DoubleMatrix ao_vals = DoubleMatrix::Zero(N_pts, ao_idx.size());
+            DoubleMatrix ao_coefs = DoubleMatrix::Zero(ao_idx.size(), N_mo);
+            for (int a = 0; a < ao_idx.size(); a++) {
+                const auto &ao_a = aos[ao_idx[a]];
+                for (int p = 0; p < N_pts; p++) ao_vals(p, a) = ao_a.evalf({pts(0, p), pts(1, p), pts(2, p)});
+                ao_coefs.row(a) = C.row(ao_idx[a]);
+            }
+            DoubleMatrix mo_vals = ao_vals * ao_coefs;
+
+            for (int i = 0; i < N_mo; i++) {
+                Eigen::VectorXd vals_i = mo_vals.col(i);
+                trees[i]->getEndFuncNode(n).setValues(vals_i);
+            }
+        }
+
+        int n_split = 0;
+        for (auto *tree : trees) {
+            tree->mwTransform(mrcpp::BottomUp);
+            tree->calcSquareNorm();
+            n_split += mrcpp::refine_grid(*tree, prec);
+        }
+        if (n_split == 0) break;
+        for (auto *tree : trees) mrcpp::build_grid(grid, *tree);
+    }
+}
+
 /** @brief Project the N first GTO expansions of the AO basis
  *
  * @param Phi: vector or MW orbitals
@@ -198,6 +310,9 @@ void initial_guess::gto::project_ao(OrbitalVector &Phi, double prec, const Nucle
 
     const char label[10] = "spdfg";
 
+    // Collect the AO expansions, the orbitals are distributed by their rank
+    std::vector<GaussExp<3>> ao_exps;
+    std::vector<std::string> ao_txts;
     for (const auto &nuc : nucs) {
         std::string sad_path;
         for (auto n : {sad_basis_source_dir(), sad_basis_install_dir()}) {
@@ -216,42 +331,65 @@ void initial_guess::gto::project_ao(OrbitalVector &Phi, double prec, const Nucle
         intgrl.getNucleus(0).setCoord(nuc.getCoord());
         gto_utils::OrbitalExp gto_exp(intgrl);
 
-        int n = 0;
         for (int i = 0; i < gto_exp.size(); i++) {
-            Timer t_i;
             Phi.push_back(Orbital(SPIN::Paired));
             Phi.back().setRank(Phi.size() - 1);
-            GaussExp<3> ao_i = gto_exp.getAO(i);
-            ao_i.calcScreening(screen);
-            if (mrcpp::mpi::my_func(Phi.back())) {
-                mrcpp::project(Phi.back(), ao_i, prec);
-                if (std::abs(Phi.back().norm() - 1.0) > 0.01) MSG_WARN("AO not normalized!");
-            }
+            ao_exps.push_back(gto_exp.getAO(i));
+            ao_exps.back().calcScreening(screen);
 
-            auto l = ao_i.getPower(0);
+            auto l = ao_exps.back().getPower(0);
             auto L = l[0] + l[1] + l[2];
 
             std::stringstream o_txt;
             o_txt << std::setw(w1 - 1) << Phi.size();
             o_txt << std::setw(w4) << nuc.getElement().getSymbol();
             o_txt << std::setw(w2 - 1) << label[L];
-            print_utils::qmfunction(2, o_txt.str(), Phi.back(), t_i);
+            ao_txts.push_back(o_txt.str());
         }
     }
+
+    // Project the local AOs concurrently
+    auto first = Phi.size() - ao_exps.size();
+    std::vector<Timer> t_aos(ao_exps.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < ao_exps.size(); i++) {
+        t_aos[i].start();
+        if (mrcpp::mpi::my_func(Phi[first + i])) mrcpp::project(Phi[first + i], ao_exps[i], prec);
+        t_aos[i].stop();
+    }
+
+    for (int i = 0; i < ao_exps.size(); i++) {
+        auto &phi_i = Phi[first + i];
+        if (mrcpp::mpi::my_func(phi_i) and std::abs(phi_i.norm() - 1.0) > 0.01) MSG_WARN("AO not normalized!");
+        print_utils::qmfunction(2, ao_txts[i], phi_i, t_aos[i]);
+    }
     mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
     timer.stop();
     mrcpp::print::footer(2, timer, 2);
 }
 
-Density initial_guess::gto::project_density(double prec, const Nucleus &nuc, const std::string &bas_file, const std::string &dens_file, double screen) {
+/** @brief Analytic GTO expansion of an atomic density
+ *
+ * @param R: position of the atom
+ * @param bas_file: basis set file (LSDalton format)
+ * @param dens_file: file with density matrix
+ *
+ * No screening is applied, so the expansion can be translated to other
+ * positions before screening and projection.
+ */
+GaussExp<3> initial_guess::gto::expand_density(const mrcpp::Coord<3> &R, const std::string &bas_file, const std::string &dens_file) {
     // Setup AO basis
     gto_utils::Intgrl intgrl(bas_file);
-    intgrl.getNucleus(0).setCoord(nuc.getCoord());
+    intgrl.getNucleus(0).setCoord(R);
     gto_utils::OrbitalExp gto_exp(intgrl);
 
     // Read density matrix file
     DoubleMatrix D = math_utils::read_matrix_file(dens_file);
-    GaussExp<3> dens_exp = gto_exp.getDens(D);
+    return gto_exp.getDens(D);
+}
+
+Density initial_guess::gto::project_density(double prec, const Nucleus &nuc, const std::string &bas_file, const std::string &dens_file, double screen) {
+    GaussExp<3> dens_exp = expand_density(nuc.getCoord(), bas_file, dens_file);
     dens_exp.calcScreening(screen);
 
     Density rho(false);
@@ -27,6 +27,8 @@
 
 #include <string>
 
+#include <MRCPP/Gaussians>
+
 #include "qmfunctions/qmfunction_fwd.h"
 
 /** @file gto.h
@@ -62,6 +64,9 @@ void project_ao(OrbitalVector &Phi,
                 double prec,
                 const Nuclei &nucs,
                 double screen = -1.0);
+mrcpp::GaussExp<3> expand_density(const mrcpp::Coord<3> &R,
+                                  const std::string &bas_file,
+                                  const std::string &dens_file);
 Density project_density(double prec,
                         const Nucleus &nuc,
                         const std::string &bas_file,
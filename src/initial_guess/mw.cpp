@@ -23,14 +23,19 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <MRCPP/MWFunctions>
 #include <MRCPP/Printer>
 #include <MRCPP/Timer>
 
 #include "mw.h"
 
+#include "chemistry/Nucleus.h"
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/orbital_utils.h"
+#include "utils/math_utils.h"
 #include "utils/print_utils.h"
 
 using mrcpp::Printer;
@@ -42,6 +47,7 @@ namespace initial_guess {
 namespace mw {
 
 bool project_mo(OrbitalVector &Phi, double prec, const std::string &mo_file);
+void lowdin_orthonormalize(OrbitalVector &Phi, double prec);
 
 } // namespace mw
 } // namespace initial_guess
@@ -134,4 +140,88 @@ bool initial_guess::mw::project_mo(OrbitalVector &Phi, double prec, const std::s
     return success;
 }
 
+/** @brief Carry orbitals along with displaced nuclei
+ *
+ * @param Phi: orbitals at the previous geometry, replaced on exit
+ * @param prec: precision used in projection
+ * @param nucs_prev: nuclei at the previous geometry
+ * @param nucs: nuclei at the new geometry
+ *
+ * The orbitals are re-projected as phi'(r) = phi(r - d(r)), where the
+ * displacement field d(r) = sum_A w_A(r) (R_A - R_A^prev) interpolates the
+ * nuclear displacements with a Gaussian partition of unity w_A centered on
+ * the new nuclei. Close to a nucleus the orbital thus follows it rigidly, and
+ * in between the displacement varies smoothly. The mapping is not unitary, so
+ * the orbitals are Lowdin orthonormalized afterwards, separately for each spin.
+ * Complex orbitals are passed on untransformed.
+ */
+bool initial_guess::mw::follow_nuclei(OrbitalVector &Phi, double prec, const Nuclei &nucs_prev, const Nuclei &nucs) {
+    if (Phi.size() == 0) return false;
+    if (nucs_prev.size() != nucs.size()) MSG_ABORT("Size mismatch");
+
+    Timer t_tot;
+    mrcpp::print::separator(0, '~');
+    print_utils::text(0, "Calculation   ", "Compute initial orbitals");
+    print_utils::text(0, "Method        ", "Follow nuclei from previous geometry");
+    print_utils::text(0, "Precision     ", print_utils::dbl_to_str(prec, 5, true));
+    mrcpp::print::separator(0, '~', 2);
+
+    // Width parameter of the partition of unity
+    const double alpha = 1.0;
+    int N_nucs = nucs.size();
+    std::vector<mrcpp::Coord<3>> R(N_nucs), dR(N_nucs);
+    for (int k = 0; k < N_nucs; k++) {
+        R[k] = nucs[k].getCoord();
+        for (int d = 0; d < 3; d++) dR[k][d] = nucs[k].getCoord()[d] - nucs_prev[k].getCoord()[d];
+    }
+    auto displace = [R, dR, alpha, N_nucs](const mrcpp::Coord<3> &r) -> mrcpp::Coord<3> {
+        // weights relative to the closest nucleus to avoid underflow far from the molecule
+        std::vector<double> r2(N_nucs);
+        for (int k = 0; k < N_nucs; k++) r2[k] = math_utils::calc_distance(r, R[k]) * math_utils::calc_distance(r, R[k]);
+        double r2_min = *std::min_element(r2.begin(), r2.end());
+        double w_sum = 0.0;
+        mrcpp::Coord<3> r_prev = r;
+        for (int k = 0; k < N_nucs; k++) {
+            double w_k = std::exp(-alpha * (r2[k] - r2_min));
+            for (int d = 0; d < 3; d++) r_prev[d] -= w_k * dR[k][d];
+            w_sum += w_k;
+        }
+        for (int d = 0; d < 3; d++) r_prev[d] = r[d] + (r_prev[d] - r[d]) / w_sum;
+        return r_prev;
+    };
+
+    OrbitalVector Psi = orbital::param_copy(Phi);
+    for (int i = 0; i < Phi.size(); i++) {
+        if (not mrcpp::mpi::my_func(Phi[i])) continue;
+        if (Phi[i].isreal()) {
+            auto &phi_i = Phi[i].real();
+            // Refine to get accurate function values
+            mrcpp::refine_grid(phi_i, 1);
+            auto f_i = [&phi_i, &displace](const mrcpp::Coord<3> &r) -> double { return phi_i.evalf(displace(r)); };
+            Psi[i].alloc(1);
+            mrcpp::project(prec, Psi[i].real(), f_i);
+        } else {
+            Psi[i] = Phi[i];
+        }
+    }
+    Phi = Psi;
+
+    auto Phi_a = orbital::disjoin(Phi, SPIN::Alpha);
+    auto Phi_b = orbital::disjoin(Phi, SPIN::Beta);
+    initial_guess::mw::lowdin_orthonormalize(Phi, prec);
+    initial_guess::mw::lowdin_orthonormalize(Phi_a, prec);
+    initial_guess::mw::lowdin_orthonormalize(Phi_b, prec);
+    Phi = orbital::adjoin(Phi, Phi_a);
+    Phi = orbital::adjoin(Phi, Phi_b);
+
+    mrcpp::print::time(1, "Following nuclei", t_tot);
+    return true;
+}
+
+void initial_guess::mw::lowdin_orthonormalize(OrbitalVector &Phi, double prec) {
+    if (Phi.size() == 0) return;
+    ComplexMatrix S_m12 = orbital::calc_lowdin_matrix(Phi);
+    Phi = orbital::rotate(Phi, S_m12, prec);
+}
+
 } // namespace mrchem
@@ -38,10 +38,13 @@
  */
 
 namespace mrchem {
+class Nuclei;
+
 namespace initial_guess {
 namespace mw {
 
 bool setup(OrbitalVector &Phi, double prec, const std::string &file_p, const std::string &file_a, const std::string &file_b);
+bool follow_nuclei(OrbitalVector &Phi, double prec, const Nuclei &nucs_prev, const Nuclei &nucs);
 
 } // namespace mw
 } // namespace initial_guess
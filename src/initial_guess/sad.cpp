@@ -23,6 +23,8 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <map>
+
 #include <MRCPP/MWOperators>
 #include <MRCPP/Parallel>
 #include <MRCPP/Printer>
@@ -56,15 +58,44 @@ namespace mrchem {
 namespace initial_guess {
 namespace sad {
 
+/** @brief Atomic SAD density of one element, kept between guesses */
+struct AtomicDensity {
+    mrcpp::GaussExp<3> expansion; ///< Analytic GTO density centered at the origin
+    double charge{0.0};           ///< Integrated electronic charge
+    double prec{-1.0};            ///< Precision used to integrate the charge
+    double screen{-1.0};          ///< GTO screening used to integrate the charge
+};
+
 void project_atomic_densities(double prec, Density &rho_tot, const Nuclei &nucs, double screen = -1.0);
+const AtomicDensity &get_atomic_density(double prec, const Nucleus &nuc, const std::string &sad_path, double screen);
+void translate_expansion(mrcpp::GaussExp<3> &exp, const mrcpp::Coord<3> &R);
 
 } // namespace sad
 } // namespace initial_guess
 
-bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, const Nuclei &nucs, int zeta) {
+/** @brief Diagonalize the Fock matrix of a superposition of atomic densities
+ *
+ * @param Phi: orbitals to compute, must be allocated with the correct spins
+ * @param prec: precision used in projections and operator applications
+ * @param screen: GTO screening in StdDev
+ * @param nucs: nuclei of the molecule
+ * @param basis: AO basis used to diagonalize the Fock matrix
+ * @param zeta: zeta quality of the hydrogen AO basis (unused for GTOs)
+ * @param fragments: screen the Fock matrix by covalently bonded fragments
+ *
+ * With fragments, the AOs are ordered fragment by fragment, and couplings
+ * between distant fragments are neglected, see
+ * core::diagonalize_fragments(). The neglected overlaps are removed by a
+ * Lowdin orthonormalization of the occupied orbitals.
+ */
+bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, const Nuclei &nucs, AOBasis basis, int zeta, bool fragments) {
     if (Phi.size() == 0) return false;
 
+    // Fragments further apart than this are not coupled in the Fock matrix
+    const double frag_cutoff = 12.0;
+
     auto restricted = (orbital::size_singly(Phi)) ? false : true;
+    auto frags = (fragments) ? initial_guess::core::partition_fragments(nucs) : std::vector<Nuclei>{nucs};
     mrcpp::print::separator(0, '~');
     print_utils::text(0, "Calculation ", "Compute initial orbitals");
     print_utils::text(0, "Method      ", "Diagonalize SAD Hamiltonian");
@@ -72,8 +103,13 @@ bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, c
     print_utils::text(0, "Screening   ", print_utils::dbl_to_str(screen, 5, true) + " StdDev");
     print_utils::text(0, "Restricted  ", (restricted) ? "True" : "False");
     print_utils::text(0, "Functional  ", "LDA (SVWN5)");
-    print_utils::text(0, "AO basis    ", "Hydrogenic orbitals");
-    print_utils::text(0, "Zeta quality", std::to_string(zeta));
+    if (basis == AOBasis::Hydrogen) {
+        print_utils::text(0, "AO basis    ", "Hydrogenic orbitals");
+        print_utils::text(0, "Zeta quality", std::to_string(zeta));
+    } else {
+        print_utils::text(0, "AO basis    ", "3-21G");
+    }
+    if (fragments) print_utils::text(0, "Fragments   ", std::to_string(frags.size()));
     mrcpp::print::separator(0, '~', 2);
 
     // Make Fock operator contributions
@@ -107,11 +143,17 @@ bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, c
     mrcpp::deep_copy(rho_xc, rho_j);
     if (plevel == 1) mrcpp::print::time(1, "Projecting GTO density", t_lap);
 
-    // Project AO basis of hydrogen functions
+    // Project AO basis
     t_lap.start();
     OrbitalVector Psi;
-    initial_guess::core::project_ao(Psi, prec, nucs, zeta);
-    if (plevel == 1) mrcpp::print::time(1, "Projecting Hydrogen AOs", t_lap);
+    std::vector<int> frag_sizes;
+    for (const auto &nucs_f : frags) {
+        auto n_ao = Psi.size();
+        if (basis == AOBasis::Hydrogen) initial_guess::core::project_ao(Psi, prec, nucs_f, zeta);
+        if (basis == AOBasis::GTO) initial_guess::gto::project_ao(Psi, prec, nucs_f);
+        frag_sizes.push_back(Psi.size() - n_ao);
+    }
+    if (plevel == 1) mrcpp::print::time(1, (basis == AOBasis::Hydrogen) ? "Projecting Hydrogen AOs" : "Projecting GTO AOs", t_lap);
 
     if (plevel == 2) mrcpp::print::header(2, "Building Fock operator");
     t_lap.start();
@@ -122,84 +164,13 @@ bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, c
 
     // Compute Fock matrix
     mrcpp::print::header(2, "Diagonalizing Fock matrix");
-    ComplexMatrix U = initial_guess::core::diagonalize(Psi, p, V);
-
-    // Rotate orbitals and fill electrons by Aufbau
-    t_lap.start();
-    auto Phi_a = orbital::disjoin(Phi, SPIN::Alpha);
-    auto Phi_b = orbital::disjoin(Phi, SPIN::Beta);
-    initial_guess::core::rotate_orbitals(Phi, prec, U, Psi);
-    initial_guess::core::rotate_orbitals(Phi_a, prec, U, Psi);
-    initial_guess::core::rotate_orbitals(Phi_b, prec, U, Psi);
-    Phi = orbital::adjoin(Phi, Phi_a);
-    Phi = orbital::adjoin(Phi, Phi_b);
-    p.clear();
-    V.clear();
-
-    mrcpp::print::footer(2, t_tot, 2);
-    if (plevel == 1) mrcpp::print::footer(1, t_tot, 2);
-    return true;
-}
-
-bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, const Nuclei &nucs) {
-    if (Phi.size() == 0) return false;
-
-    auto restricted = (orbital::size_singly(Phi)) ? false : true;
-    mrcpp::print::separator(0, '~');
-    print_utils::text(0, "Calculation ", "Compute initial orbitals");
-    print_utils::text(0, "Method      ", "Diagonalize SAD Hamiltonian");
-    print_utils::text(0, "Precision   ", print_utils::dbl_to_str(prec, 5, true));
-    print_utils::text(0, "Screening   ", print_utils::dbl_to_str(screen, 5, true) + " StdDev");
-    print_utils::text(0, "Restricted  ", (restricted) ? "True" : "False");
-    print_utils::text(0, "Functional  ", "LDA (SVWN5)");
-    print_utils::text(0, "AO basis    ", "3-21G");
-    mrcpp::print::separator(0, '~', 2);
-
-    // Make Fock operator contributions
-    Timer t_tot, t_lap;
-    auto P_p = std::make_shared<mrcpp::PoissonOperator>(*MRA, prec);
-    auto D_p = std::make_shared<mrcpp::ABGVOperator<3>>(*MRA, 0.0, 0.0);
-
-    mrdft::Factory xc_factory(*MRA);
-    xc_factory.setSpin(false);
-    xc_factory.setFunctional("SLATERX", 1.0);
-    xc_factory.setFunctional("VWN5C", 1.0);
-    auto mrdft_p = xc_factory.build();
-    MomentumOperator p(D_p);
-    NuclearOperator V_nuc(nucs, prec);
-    CoulombOperator J(P_p);
-    XCOperator XC(mrdft_p);
-    RankZeroOperator V = V_nuc + J + XC;
-
-    auto plevel = Printer::getPrintLevel();
-    if (plevel == 1) mrcpp::print::header(1, "SAD Initial Guess");
-    if (plevel == 1) mrcpp::print::time(1, "Initializing operators", t_lap);
-
-    // Compute Coulomb density
-    t_lap.start();
-    Density &rho_j = J.getDensity();
-    initial_guess::sad::project_atomic_densities(prec, rho_j, nucs, screen);
-
-    // Compute XC density
-    Density &rho_xc = XC.getDensity(DensityType::Total);
-    mrcpp::deep_copy(rho_xc, rho_j);
-    if (plevel == 1) mrcpp::print::time(1, "Projecting GTO density", t_lap);
-
-    // Project AO basis of hydrogen functions
-    t_lap.start();
-    OrbitalVector Psi;
-    initial_guess::gto::project_ao(Psi, prec, nucs);
-    if (plevel == 1) mrcpp::print::time(1, "Projecting GTO AOs", t_lap);
-    if (plevel == 2) mrcpp::print::header(2, "Building Fock operator");
-    t_lap.start();
-    p.setup(prec);
-    V.setup(prec);
-    if (plevel == 2) mrcpp::print::footer(2, t_lap, 2);
-    if (plevel == 1) mrcpp::print::time(1, "Building Fock operator", t_lap);
+    ComplexMatrix U;
+    if (fragments) {
+        U = initial_guess::core::diagonalize_fragments(Psi, p, V, frags, frag_sizes, frag_cutoff);
+    } else {
+        U = initial_guess::core::diagonalize(Psi, p, V);
+    }
 
-    // Compute Fock matrix
-    mrcpp::print::header(2, "Diagonalizing Fock matrix");
-    ComplexMatrix U = initial_guess::core::diagonalize(Psi, p, V);
     // Rotate orbitals and fill electrons by Aufbau
     t_lap.start();
     auto Phi_a = orbital::disjoin(Phi, SPIN::Alpha);
@@ -207,6 +178,15 @@ bool initial_guess::sad::setup(OrbitalVector &Phi, double prec, double screen, c
     initial_guess::core::rotate_orbitals(Phi, prec, U, Psi);
     initial_guess::core::rotate_orbitals(Phi_a, prec, U, Psi);
     initial_guess::core::rotate_orbitals(Phi_b, prec, U, Psi);
+    if (fragments) {
+        t_lap.start();
+        for (auto Phi_s : {&Phi, &Phi_a, &Phi_b}) {
+            if (Phi_s->size() == 0) continue;
+            ComplexMatrix S_m12 = orbital::calc_lowdin_matrix(*Phi_s);
+            *Phi_s = orbital::rotate(*Phi_s, S_m12, prec);
+        }
+        mrcpp::print::time(1, "Orthonormalizing orbitals", t_lap);
+    }
     Phi = orbital::adjoin(Phi, Phi_a);
     Phi = orbital::adjoin(Phi, Phi_b);
     p.clear();
@@ -251,23 +231,27 @@ void initial_guess::sad::project_atomic_densities(double prec, Density &rho_tot,
     rho_loc.alloc(1);
     rho_loc.real().setZero();
 
+    // Translate the cached element densities onto the local nuclei
+    // and project their sum in one go
     Timer t_loc;
     auto N_nucs = nucs.size();
     DoubleVector charges = DoubleVector::Zero(2 * N_nucs);
+    mrcpp::GaussExp<3> dens_exp;
     for (int k = 0; k < N_nucs; k++) {
         if (mrcpp::mpi::wrk_rank != k % mrcpp::mpi::wrk_size) continue;
 
-        const std::string &sym = nucs[k].getElement().getSymbol();
-        std::stringstream o_bas, o_dens;
-        o_bas << sad_path << "/" << sym << ".bas";
-        o_dens << sad_path << "/" << sym << ".dens";
-
-        Density rho_k = initial_guess::gto::project_density(prec, nucs[k], o_bas.str(), o_dens.str(), screen);
-        rho_loc.add(1.0, rho_k);
-        rho_loc.crop(crop_prec);
+        const auto &atom = initial_guess::sad::get_atomic_density(prec, nucs[k], sad_path, screen);
+        mrcpp::GaussExp<3> exp_k(atom.expansion);
+        initial_guess::sad::translate_expansion(exp_k, nucs[k].getCoord());
+        dens_exp.append(exp_k);
 
         charges[k] = nucs[k].getCharge();
-        charges[N_nucs + k] = rho_k.integrate().real();
+        charges[N_nucs + k] = atom.charge;
+    }
+    if (dens_exp.size() > 0) {
+        dens_exp.calcScreening(screen);
+        density::compute(prec, rho_loc, dens_exp);
+        rho_loc.crop(crop_prec);
     }
     t_loc.stop();
     Timer t_com;
@@ -302,4 +286,60 @@ void initial_guess::sad::project_atomic_densities(double prec, Density &rho_tot,
     mrcpp::print::footer(2, t_tot, 2);
 }
 
+/** @brief Return the cached SAD density of the element of the given nucleus
+ *
+ * @param prec: precision used to integrate the charge
+ * @param nuc: nucleus whose element is requested
+ * @param sad_path: directory with the SAD basis and density matrix files
+ * @param screen: GTO screening in StdDev
+ *
+ * The basis and density matrix files are read only the first time an element
+ * is requested from a given directory. The analytic expansion is stored
+ * centered at the origin, to be translated onto each nucleus of the same
+ * element. The electronic charge is translation invariant and is integrated
+ * from a projection at the first nucleus, and again whenever a tighter
+ * precision or a different screening is requested. The cache lives for the
+ * whole run, so repeated SAD guesses (e.g. during geometry optimization) do
+ * not touch the files again.
+ */
+const initial_guess::sad::AtomicDensity &initial_guess::sad::get_atomic_density(double prec, const Nucleus &nuc, const std::string &sad_path, double screen) {
+    static std::map<std::string, AtomicDensity> atomic_densities;
+
+    const std::string &sym = nuc.getElement().getSymbol();
+    std::stringstream o_bas, o_dens;
+    o_bas << sad_path << "/" << sym << ".bas";
+    o_dens << sad_path << "/" << sym << ".dens";
+
+    auto it = atomic_densities.find(o_dens.str());
+    if (it == atomic_densities.end()) {
+        AtomicDensity atom;
+        atom.expansion = initial_guess::gto::expand_density({0.0, 0.0, 0.0}, o_bas.str(), o_dens.str());
+        it = atomic_densities.emplace(o_dens.str(), std::move(atom)).first;
+    }
+
+    AtomicDensity &atom = it->second;
+    if (atom.prec > 0.0 and atom.prec <= prec and atom.screen == screen) return atom;
+
+    mrcpp::GaussExp<3> exp_nuc(atom.expansion);
+    initial_guess::sad::translate_expansion(exp_nuc, nuc.getCoord());
+    exp_nuc.calcScreening(screen);
+    Density rho(false);
+    density::compute(prec, rho, exp_nuc);
+    atom.charge = rho.integrate().real();
+    atom.prec = prec;
+    atom.screen = screen;
+
+    return atom;
+}
+
+/** @brief Rigidly translate all terms of a GTO expansion by R */
+void initial_guess::sad::translate_expansion(mrcpp::GaussExp<3> &exp, const mrcpp::Coord<3> &R) {
+    for (int i = 0; i < exp.size(); i++) {
+        auto &func_i = exp.getFunc(i);
+        auto pos_i = func_i.getPos();
+        for (int d = 0; d < 3; d++) pos_i[d] += R[d];
+        func_i.setPos(pos_i);
+    }
+}
+
 } // namespace mrchem
@@ -41,8 +41,13 @@ class Nuclei;
 namespace initial_guess {
 namespace sad {
 
-bool setup(OrbitalVector &Phi, double prec, double screen, const Nuclei &nucs, int zeta);
-bool setup(OrbitalVector &Phi, double prec, double screen, const Nuclei &nucs);
+/** @brief AO basis used to diagonalize the SAD Hamiltonian */
+enum class AOBasis {
+    Hydrogen, ///< Hydrogen functions of the given zeta quality
+    GTO       ///< 3-21G Gaussian basis
+};
+
+bool setup(OrbitalVector &Phi, double prec, double screen, const Nuclei &nucs, AOBasis basis, int zeta, bool fragments);
 
 } // namespace sad
 } // namespace initial_guess
@@ -36,7 +36,9 @@
 
 #include "chemistry/Molecule.h"
 #include "chemistry/PhysicalConstants.h"
+#include "qmoperators/two_electron/FockBuilder.h"
 
+#include "vc_sqnm/mrchem_hessian.hpp"
 #include "vc_sqnm/mrchem_optimizer.hpp"
 
 // Initializing global variables
@@ -60,6 +62,7 @@ int main(int argc, char **argv) {
     const auto &rsp_inp = json_inp["rsp_calculations"];
     const auto &con_inp = json_inp["constants"];
     const auto &geopt_inp = json_inp["geom_opt"];
+    const auto &hess_inp = json_inp["hessian"];
 
     // Instantiate the physical constants singleton
     PhysicalConstants::Initialize(con_inp);
@@ -68,17 +71,23 @@ int main(int argc, char **argv) {
     Timer timer;
     json json_out;
 
+    if (geopt_inp["run"] and hess_inp["run"]) MSG_ABORT("Geometry optimization and Hessian cannot be combined");
+
     if (geopt_inp["run"]) {
         json_out = optimize_positions(scf_inp, mol_inp, geopt_inp, json_inp["printer"]["file_name"]);
         mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
+    } else if (hess_inp["run"]) {
+        json_out = hessian_frequencies(scf_inp, mol_inp, hess_inp);
+        mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
     } else {
         Molecule mol;
         driver::init_molecule(mol_inp, mol);
-        auto scf_out = driver::scf::run(scf_inp, mol);
+        // the converged ground-state operator is handed over to the response calculations
+        driver::FockHandoff handoff;
+        auto scf_out = driver::scf::run(scf_inp, mol, (rsp_inp.empty()) ? nullptr : &handoff);
         json rsp_out = {};
-        if (scf_out["success"]) {
-            for (auto &i : rsp_inp.items()) rsp_out[i.key()] = driver::rsp::run(i.value(), mol);
-        }
+        if (scf_out["success"]) rsp_out = driver::rsp::run(rsp_inp, mol, &handoff);
+        if (handoff.F != nullptr) handoff.F->clear();
         mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
         // Name and version of the output schema
         json_out["schema_name"] = "mrchem_output";
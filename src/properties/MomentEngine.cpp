@@ -0,0 +1,148 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include <MRCPP/Parallel>
+#include <MRCPP/Printer>
+#include <MRCPP/Timer>
+
+#include "MomentEngine.h"
+
+#include "chemistry/Nucleus.h"
+#include "qmfunctions/Density.h"
+
+using mrcpp::Printer;
+using mrcpp::Timer;
+
+namespace mrchem {
+
+namespace {
+double binomial(int n, int k) {
+    double out = 1.0;
+    for (int i = 1; i <= k; i++) out *= static_cast<double>(n - k + i) / i;
+    return out;
+}
+} // namespace
+
+/** @brief Integrate the Cartesian moments of an electronic density
+ *
+ * @param order: highest total degree a + b + c of the moments
+ * @param prec: precision used when projecting the monomials
+ * @param rho: density to integrate
+ *
+ * Monomials of degree <= k are represented exactly by the scaling functions
+ * at the root scale, so each projection stops at the root nodes and the dot
+ * product with the density only touches its coarsest level. The monomials
+ * are distributed over the MPI ranks and the moments are reduced at the end.
+ */
+MomentEngine::MomentEngine(int order, double prec, Density &rho)
+        : order(order) {
+    if (order < 0) MSG_ABORT("Invalid moment order");
+    Timer t_tot;
+    this->moments = DoubleVector::Zero((order + 1) * (order + 1) * (order + 1));
+
+    int n = 0;
+    for (int a = 0; a <= order; a++) {
+        for (int b = 0; a + b <= order; b++) {
+            for (int c = 0; a + b + c <= order; c++) {
+                if (not mrcpp::mpi::my_func(n++)) continue;
+                auto monomial = [a, b, c](const mrcpp::Coord<3> &r) -> double { return std::pow(r[0], a) * std::pow(r[1], b) * std::pow(r[2], c); };
+                mrcpp::AnalyticFunction<3> p_func(monomial);
+                mrcpp::CompFunction<3> p(false);
+                mrcpp::project(p, p_func, prec);
+                this->moments(index(a, b, c)) = mrcpp::dot(p, rho).real();
+                p.free();
+            }
+        }
+    }
+    mrcpp::mpi::allreduce_vector(this->moments, mrcpp::mpi::comm_wrk);
+    mrcpp::print::time(2, "Computing Cartesian moments", t_tot);
+}
+
+/** @brief Collect the Cartesian moments of the nuclear point charges
+ *
+ * @param order: highest total degree a + b + c of the moments
+ * @param nucs: nuclei contributing Z * x^a y^b z^c at their positions
+ */
+MomentEngine::MomentEngine(int order, const Nuclei &nucs)
+        : order(order) {
+    if (order < 0) MSG_ABORT("Invalid moment order");
+    this->moments = DoubleVector::Zero((order + 1) * (order + 1) * (order + 1));
+    for (const auto &nuc : nucs) {
+        const auto &R = nuc.getCoord();
+        for (int a = 0; a <= order; a++) {
+            for (int b = 0; a + b <= order; b++) {
+                for (int c = 0; a + b + c <= order; c++) {
+                    this->moments(index(a, b, c)) += nuc.getCharge() * std::pow(R[0], a) * std::pow(R[1], b) * std::pow(R[2], c);
+                }
+            }
+        }
+    }
+}
+
+/** @brief Moment \int rho(r) (x - O_x)^a (y - O_y)^b (z - O_z)^c dr
+ *
+ * Translated from the moments about the global origin through the binomial
+ * expansion of each Cartesian factor.
+ */
+double MomentEngine::getMoment(int a, int b, int c, const mrcpp::Coord<3> &o) const {
+    if (a < 0 or b < 0 or c < 0 or a + b + c > this->order) MSG_ABORT("Moment out of range");
+    double out = 0.0;
+    for (int i = 0; i <= a; i++) {
+        double c_i = binomial(a, i) * std::pow(-o[0], a - i);
+        for (int j = 0; j <= b; j++) {
+            double c_j = binomial(b, j) * std::pow(-o[1], b - j);
+            for (int k = 0; k <= c; k++) {
+                double c_k = binomial(c, k) * std::pow(-o[2], c - k);
+                out += c_i * c_j * c_k * this->moments(index(i, j, k));
+            }
+        }
+    }
+    return out;
+}
+
+/** @brief First moments \int rho(r) (r - O) dr */
+DoubleVector MomentEngine::getFirstMoment(const mrcpp::Coord<3> &o) const {
+    DoubleVector out(3);
+    out(0) = getMoment(1, 0, 0, o);
+    out(1) = getMoment(0, 1, 0, o);
+    out(2) = getMoment(0, 0, 1, o);
+    return out;
+}
+
+/** @brief Second moments \int rho(r) (r - O)(r - O)^T dr */
+DoubleMatrix MomentEngine::getSecondMoment(const mrcpp::Coord<3> &o) const {
+    DoubleMatrix out(3, 3);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            std::array<int, 3> p{0, 0, 0};
+            p[i]++;
+            p[j]++;
+            out(i, j) = getMoment(p[0], p[1], p[2], o);
+        }
+    }
+    return out;
+}
+
+} // namespace mrchem
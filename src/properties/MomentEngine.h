@@ -0,0 +1,62 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#pragma once
+
+#include "mrchem.h"
+
+#include "chemistry/chemistry_fwd.h"
+#include "qmfunctions/qmfunction_fwd.h"
+
+namespace mrchem {
+
+/** @class MomentEngine
+ *
+ * @brief Cartesian moments of a charge distribution
+ *
+ * All moments M_abc = \int rho(r) x^a y^b z^c dr with a + b + c <= order are
+ * integrated once about the global origin. Moments about any other origin O are
+ * obtained from these by binomial expansion of (x - O_x)^a (y - O_y)^b (z - O_z)^c,
+ * so that properties for all requested origins and operators are assembled from
+ * the same set of integrals without revisiting the density.
+ */
+class MomentEngine final {
+public:
+    MomentEngine(int order, double prec, Density &rho);
+    MomentEngine(int order, const Nuclei &nucs);
+
+    int getOrder() const { return this->order; }
+    double getMoment(int a, int b, int c, const mrcpp::Coord<3> &o = {}) const;
+    DoubleVector getFirstMoment(const mrcpp::Coord<3> &o) const;
+    DoubleMatrix getSecondMoment(const mrcpp::Coord<3> &o) const;
+
+private:
+    int order;
+    DoubleVector moments; ///< M_abc about the global origin, stored at index(a, b, c)
+
+    int index(int a, int b, int c) const { return (a * (this->order + 1) + b) * (this->order + 1) + c; }
+};
+
+} // namespace mrchem
@@ -1,16 +1,95 @@
 #include "HirshfeldPartition.h"
 #include "utils/math_utils.h"
 
-HirshfeldPartition::HirshfeldPartition(const mrchem::Molecule &mol, std::string data_dir) {
+#include <MRCPP/Parallel>
+#include <algorithm>
+#include <cmath>
+
+HirshfeldPartition::HirshfeldPartition(const mrchem::Molecule &mol, std::string data_dir, double dens_thrs) {
 
     this->nucs = std::make_shared<mrchem::Nuclei>(mol.getNuclei());
     this->nNucs = this->nucs->size();
+    this->logThreshold = std::log(dens_thrs);
 
+    // read each element only once
+    std::map<std::string, std::shared_ptr<HirshfeldRadInterpolater>> elementDensities;
+    std::map<std::string, double> elementCutoffs;
     for (int i = 0; i < this->nNucs; i++) {
         std::string element = this->nucs->at(i).getElement().getSymbol();
-        this->logDensities.push_back(HirshfeldRadInterpolater(element, data_dir));
+        if (elementDensities.count(element) == 0) {
+            elementDensities[element] = std::make_shared<HirshfeldRadInterpolater>(element, data_dir);
+            elementCutoffs[element] = computeCutoff(*elementDensities[element]);
+        }
+        this->logDensities.push_back(elementDensities[element]);
+        this->cutoffs.push_back(elementCutoffs[element]);
         // Uncomment the following line to print the charge of the atomic density
-        // std::cout << "Norm of " << element << " = " << this->logDensities[i].getNorm() << std::endl;
+        // std::cout << "Norm of " << element << " = " << this->logDensities[i]->getNorm() << std::endl;
+    }
+    setupNeighbourList();
+}
+
+double HirshfeldPartition::computeCutoff(const HirshfeldRadInterpolater &logDensity) const {
+    // the densities decay monotonically and are extrapolated exponentially,
+    // so the threshold is bracketed by doubling and then located by bisection
+    double r_lo = 0.0;
+    double r_hi = 1.0;
+    while (logDensity.evalf(r_hi) >= this->logThreshold && r_hi < 1.0e3) {
+        r_lo = r_hi;
+        r_hi *= 2.0;
+    }
+    while (r_hi - r_lo > 1.0e-6) {
+        double r_mid = 0.5 * (r_lo + r_hi);
+        if (logDensity.evalf(r_mid) >= this->logThreshold) {
+            r_lo = r_mid;
+        } else {
+            r_hi = r_mid;
+        }
+    }
+    return r_hi;
+}
+
+void HirshfeldPartition::setupNeighbourList() {
+    if (this->nNucs == 0) return;
+    mrcpp::Coord<3> rMin = this->nucs->at(0).getCoord();
+    mrcpp::Coord<3> rMax = rMin;
+    for (int i = 0; i < this->nNucs; i++) {
+        const auto &R_i = this->nucs->at(i).getCoord();
+        for (int d = 0; d < 3; d++) rMin[d] = std::min(rMin[d], R_i[d]);
+        for (int d = 0; d < 3; d++) rMax[d] = std::max(rMax[d], R_i[d]);
+        this->cellSize = std::max(this->cellSize, this->cutoffs[i]);
+    }
+    for (int d = 0; d < 3; d++) {
+        this->cellOrigin[d] = rMin[d];
+        this->cellDims[d] = static_cast<int>(std::floor((rMax[d] - rMin[d]) / this->cellSize)) + 1;
+    }
+    this->cells.resize(this->cellDims[0] * this->cellDims[1] * this->cellDims[2]);
+    for (int i = 0; i < this->nNucs; i++) {
+        const auto &R_i = this->nucs->at(i).getCoord();
+        std::array<int, 3> idx;
+        for (int d = 0; d < 3; d++) idx[d] = std::min(static_cast<int>((R_i[d] - rMin[d]) / this->cellSize), this->cellDims[d] - 1);
+        this->cells[(idx[0] * this->cellDims[1] + idx[1]) * this->cellDims[2] + idx[2]].push_back(i);
+    }
+}
+
+void HirshfeldPartition::getNeighbours(const mrcpp::Coord<3> &r, std::vector<int> &nbrs) const {
+    nbrs.clear();
+    if (this->cells.size() == 0) return;
+    std::array<int, 3> lo, hi;
+    for (int d = 0; d < 3; d++) {
+        int c = static_cast<int>(std::floor((r[d] - this->cellOrigin[d]) / this->cellSize));
+        lo[d] = std::max(c - 1, 0);
+        hi[d] = std::min(c + 1, this->cellDims[d] - 1);
+        if (lo[d] > hi[d]) return;
+    }
+    for (int i = lo[0]; i <= hi[0]; i++) {
+        for (int j = lo[1]; j <= hi[1]; j++) {
+            for (int k = lo[2]; k <= hi[2]; k++) {
+                for (auto n : this->cells[(i * this->cellDims[1] + j) * this->cellDims[2] + k]) {
+                    double rr = mrchem::math_utils::calc_distance(r, this->nucs->at(n).getCoord());
+                    if (rr < this->cutoffs[n]) nbrs.push_back(n);
+                }
+            }
+        }
     }
 }
 
@@ -25,20 +104,35 @@ double HirshfeldPartition::getHirshfeldPartitionIntegral(int index, mrcpp::CompF
     return charge;
 }
 
-double HirshfeldPartition::lseLogDens(const mrcpp::Coord<3> &r) const {
-    Eigen::VectorXd lseLogDens_r(this->nNucs);
-    double rr;
-    mrcpp::Coord<3> nucPos;
+Eigen::VectorXd HirshfeldPartition::getHirshfeldPartitionIntegrals(mrcpp::CompFunction<3> &rho, double prec) const {
+    Eigen::VectorXd integrals = Eigen::VectorXd::Zero(this->nNucs);
     for (int i = 0; i < this->nNucs; i++) {
-        nucPos = this->nucs->at(i).getCoord();
-        rr = std::sqrt((r[0] - nucPos[0]) * (r[0] - nucPos[0]) + (r[1] - nucPos[1]) * (r[1] - nucPos[1]) + (r[2] - nucPos[2]) * (r[2] - nucPos[2]));
-        lseLogDens_r(i) = this->logDensities[i].evalf(rr);
+        if (!mrcpp::mpi::my_func(i)) continue;
+        integrals(i) = getHirshfeldPartitionIntegral(i, rho, prec);
+    }
+    mrcpp::mpi::allreduce_vector(integrals, mrcpp::mpi::comm_wrk);
+    return integrals;
+}
+
+double HirshfeldPartition::lseLogDens(const mrcpp::Coord<3> &r) const {
+    thread_local std::vector<int> nbrs;
+    getNeighbours(r, nbrs);
+    return lseLogDens(r, nbrs);
+}
+
+double HirshfeldPartition::lseLogDens(const mrcpp::Coord<3> &r, const std::vector<int> &nbrs) const {
+    Eigen::VectorXd lseLogDens_r(nbrs.size());
+    for (int n = 0; n < nbrs.size(); n++) {
+        int i = nbrs[n];
+        double rr = mrchem::math_utils::calc_distance(r, this->nucs->at(i).getCoord());
+        lseLogDens_r(n) = this->logDensities[i]->evalf(rr);
     }
     return mrchem::math_utils::logsumexp(lseLogDens_r);
 }
 
 double HirshfeldPartition::evalf(const mrcpp::Coord<3> &r, int iAt) const {
     mrcpp::Coord<3> nucPos = this->nucs->at(iAt).getCoord();
-    double rr = std::sqrt((r[0] - nucPos[0]) * (r[0] - nucPos[0]) + (r[1] - nucPos[1]) * (r[1] - nucPos[1]) + (r[2] - nucPos[2]) * (r[2] - nucPos[2]));
-    return std::exp(this->logDensities[iAt].evalf(rr) - this->lseLogDens(r));
+    double rr = mrchem::math_utils::calc_distance(r, nucPos);
+    if (rr >= this->cutoffs[iAt]) return 0.0;
+    return std::exp(this->logDensities[iAt]->evalf(rr) - this->lseLogDens(r));
 }
@@ -4,6 +4,8 @@
 #include "chemistry/Nucleus.h"
 #include "properties/hirshfeld/HirshfeldInterpolator.h"
 #include <Eigen/Dense>
+#include <array>
+#include <map>
 #include <mrchem.h>
 #include <string>
 
@@ -18,14 +20,23 @@ public:
      * @brief Construct a new Hirshfeld Partition object
      * @param mol The molecule for which the Hirshfeld partitioning is to be computed
      * @param data_dir The directory containing the Hirshfeld partitioning data
+     * @param dens_thrs Atomic densities below this value are neglected, this defines the cutoff radius of each element
      */
-    HirshfeldPartition(const mrchem::Molecule &mol, std::string data_dir);
+    HirshfeldPartition(const mrchem::Molecule &mol, std::string data_dir, double dens_thrs = 1.0e-10);
 
     /**
      * @brief Get the integral rho * w_i for a given atom i
      */
     double getHirshfeldPartitionIntegral(int index, mrcpp::CompFunction<3> &rho, double prec) const;
 
+    /**
+     * @brief Get the integrals rho * w_i for all atoms
+     * @details The weights w_i = rho_i / rho_pro are bounded and vanish smoothly with the
+     * atomic density, and only the atoms within their cutoff radius enter rho_pro.
+     * The atoms are distributed among the MPI ranks, the density must be available on all ranks.
+     */
+    Eigen::VectorXd getHirshfeldPartitionIntegrals(mrcpp::CompFunction<3> &rho, double prec) const;
+
 protected:
     /**
      * @brief Evaluate the analytic, interpolated Hirshfeld partitioning function at a given point
@@ -48,7 +59,45 @@ protected:
     int nNucs;
 
     /**
-     * @brief The atomic density interpolators for the nuclei
+     * @brief Log of the density threshold defining the cutoff radii
+     */
+    double logThreshold;
+
+    /**
+     * @brief The atomic density interpolators for the nuclei, shared by atoms of the same element
+     */
+    std::vector<std::shared_ptr<HirshfeldRadInterpolater>> logDensities;
+
+    /**
+     * @brief The cutoff radius of each nucleus, beyond which its atomic density is neglected
+     */
+    std::vector<double> cutoffs;
+
+    /**
+     * @brief Uniform grid of cells containing the nuclei, with cell size equal to the largest cutoff radius
+     */
+    double cellSize{0.0};
+    mrcpp::Coord<3> cellOrigin{};
+    std::array<int, 3> cellDims{};
+    std::vector<std::vector<int>> cells;
+
+    /**
+     * @brief Compute the radius where the atomic density of an element falls below the threshold
+     */
+    double computeCutoff(const HirshfeldRadInterpolater &logDensity) const;
+
+    /**
+     * @brief Sort the nuclei into the cell grid
+     */
+    void setupNeighbourList();
+
+    /**
+     * @brief Collect the nuclei whose cutoff radius includes the point r
+     */
+    void getNeighbours(const mrcpp::Coord<3> &r, std::vector<int> &nbrs) const;
+
+    /**
+     * @brief Evaluate the log of the promolecular density from the given nuclei
      */
-    std::vector<HirshfeldRadInterpolater> logDensities;
+    double lseLogDens(const mrcpp::Coord<3> &r, const std::vector<int> &nbrs) const;
 };
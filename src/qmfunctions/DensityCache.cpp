@@ -0,0 +1,86 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include "MRCPP/Printer"
+#include "MRCPP/Timer"
+
+#include "DensityCache.h"
+#include "density_utils.h"
+#include "utils/print_utils.h"
+
+using mrcpp::Timer;
+
+namespace mrchem {
+
+/** @brief Fetch (and compute if necessary) a density
+ *
+ * @param prec: requested precision
+ * @param Phi: orbitals defining the density
+ * @param spin: type of density
+ *
+ * If a matching density of sufficient precision is present in the cache it
+ * is returned directly, otherwise it is computed with density::compute()
+ * and stored for later use within the same orbital set version.
+ *
+ * Returns a shallow copy, the trees are still owned by the cache.
+ */
+Density DensityCache::get(double prec, OrbitalVector &Phi, DensityType spin) {
+    for (auto &entry : this->entries) {
+        if (entry.orbitals != &Phi) continue;
+        if (entry.version != this->version) continue;
+        if (entry.spin != spin) continue;
+        if (entry.prec > prec) continue;
+        return entry.rho;
+    }
+
+    Timer timer;
+    Density rho(false);
+    density::compute(prec, rho, Phi, spin);
+    this->entries.push_back({&Phi, this->version, prec, spin, rho});
+    print_utils::qmfunction(3, "Compute cached density", rho, timer);
+    return rho;
+}
+
+/** @brief Store an externally obtained density (e.g. read from disk)
+ *
+ * @param prec: precision of the density
+ * @param Phi: orbitals defining the density
+ * @param spin: type of density
+ * @param rho: the density, ownership of the trees is taken over by the cache
+ *
+ * The entry is valid for the current orbital set version.
+ */
+void DensityCache::put(double prec, OrbitalVector &Phi, DensityType spin, Density &rho) {
+    this->entries.push_back({&Phi, this->version, prec, spin, rho});
+}
+
+/** @brief Free all cached densities and bump the orbital set version */
+void DensityCache::clear() {
+    for (auto &entry : this->entries) entry.rho.free();
+    this->entries.clear();
+    this->version++;
+}
+
+} // namespace mrchem
@@ -0,0 +1,81 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#pragma once
+
+#include "Density.h"
+#include "Orbital.h"
+#include "mrchem.h"
+
+/** @class DensityCache
+ *
+ * @brief Electron densities shared between operators within one SCF cycle
+ *
+ * Several ground-state operators (Coulomb, XC, reaction field) and the energy
+ * trace in FockBuilder need the very same electron density. Instead of having
+ * each of them compute (and MPI reduce/broadcast) their own copy, the densities
+ * are computed once by the cache and borrowed by all consumers.
+ *
+ * Entries are keyed by the orbital set, the orbital set version, the precision
+ * and the spin type. The version is bumped by clear(), which is called by the
+ * FockBuilder whenever its operators are cleared, i.e. whenever the orbitals are
+ * about to change. A density computed at a tighter precision than requested is
+ * considered valid.
+ *
+ * NOTE: get() returns shallow copies of the cached densities. The trees are
+ * owned by the cache, and consumers must NOT free() the borrowed density, but
+ * rather release it by assigning an empty Density.
+ */
+
+namespace mrchem {
+
+class DensityCache final {
+public:
+    DensityCache() = default;
+    DensityCache(const DensityCache &cache) = delete;
+    DensityCache &operator=(const DensityCache &cache) = delete;
+    ~DensityCache() { clear(); }
+
+    Density get(double prec, OrbitalVector &Phi, DensityType spin);
+    void put(double prec, OrbitalVector &Phi, DensityType spin, Density &rho);
+
+    int getVersion() const { return this->version; }
+    int size() const { return this->entries.size(); }
+    void clear();
+
+private:
+    struct Entry {
+        const OrbitalVector *orbitals; ///< Orbital set defining the density
+        int version;                   ///< Orbital set version at time of construction
+        double prec;                   ///< Precision used to compute the density
+        DensityType spin;              ///< Spin type of the density
+        Density rho;                   ///< Cached density (owned by the cache)
+    };
+
+    int version{0};
+    std::vector<Entry> entries;
+};
+
+} // namespace mrchem
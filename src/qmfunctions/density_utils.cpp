@@ -28,12 +28,15 @@
 #include "MRCPP/Parallel"
 #include "MRCPP/Printer"
 #include "MRCPP/Timer"
+#include "MRCPP/trees/FunctionNode.h"
 
 #include "Density.h"
 #include "Orbital.h"
 #include "density_utils.h"
 #include "orbital_utils.h"
+#include "utils/mpi_utils.h"
 #include <fstream>
+#include <set>
 
 using mrcpp::FunctionTree;
 using mrcpp::FunctionTreeVector;
@@ -52,6 +55,8 @@ Density compute(double prec, Orbital phi, DensityType spin);
 void compute_local_X(double prec, Density &rho, OrbitalVector &Phi, OrbitalVector &X, DensityType spin);
 void compute_local_XY(double prec, Density &rho, OrbitalVector &Phi, OrbitalVector &X, OrbitalVector &Y, DensityType spin);
 double compute_occupation(const Orbital &phi, DensityType dens_spin);
+bool fused_kernel_available(OrbitalVector &Phi);
+void compute_products(double prec, Density &rho, const std::vector<double> &coefs, std::vector<FunctionTree<3> *> &bra, std::vector<FunctionTree<3> *> &ket);
 } // namespace density
 
 double density::compute_occupation(const Orbital &phi, DensityType dens_spin) {
@@ -88,8 +93,8 @@ Density density::compute(double prec, Orbital phi, DensityType spin) {
 
 /** @brief Compute density as the sum of squared orbitals
  *
- * MPI: Each rank first computes its own local density, which is then reduced
- *      to rank = 0 and broadcasted to all ranks.
+ * MPI: Each rank first computes its own local density, which is then summed
+ *      up and distributed to all ranks.
  *
  */
 void density::compute(double prec, Density &rho, OrbitalVector &Phi, DensityType spin) {
@@ -104,8 +109,8 @@ void density::compute(double prec, Density &rho, OrbitalVector &Phi, DensityType
 
 /** @brief Compute transition density as rho = sum_i |x_i><phi_i| + |phi_i><y_i|
  *
- * MPI: Each rank first computes its own local density, which is then reduced
- *      to rank = 0 and broadcasted to all ranks. The rank distribution of Phi
+ * MPI: Each rank first computes its own local density, which is then summed
+ *      up and distributed to all ranks. The rank distribution of Phi
  *      and X/Y must be the same.
  *
  */
@@ -125,11 +130,32 @@ void density::compute(double prec, Density &rho, OrbitalVector &Phi, OrbitalVect
 }
 
 /** @brief Compute local density as the sum of own (MPI) orbitals
+ *
+ * For real orbitals the density is computed in a single pass over the union
+ * grid of all own orbitals (see compute_products()), and cropped only once.
+ * Complex orbitals, as well as numerically exact MPI runs, fall back to adding
+ * one orbital density at the time.
  */
 void density::compute_local(double prec, Density &rho, OrbitalVector &Phi, DensityType spin) {
     int N_el = orbital::get_electron_number(Phi);
     double abs_prec = (mrcpp::mpi::numerically_exact) ? -1.0 : prec / N_el;
 
+    if (density::fused_kernel_available(Phi)) {
+        std::vector<double> coefs;
+        std::vector<FunctionTree<3> *> bra, ket;
+        for (auto &phi_i : Phi) {
+            if (not mrcpp::mpi::my_func(phi_i)) continue;
+            double occ = density::compute_occupation(phi_i, spin);
+            if (std::abs(occ) < mrcpp::MachineZero) continue;
+            coefs.push_back(occ);
+            bra.push_back(&phi_i.real());
+            ket.push_back(&phi_i.real());
+        }
+        density::compute_products(prec, rho, coefs, bra, ket);
+        rho.crop(abs_prec);
+        return;
+    }
+
     for (auto &phi_i : Phi) {
         if (mrcpp::mpi::my_func(phi_i)) {
             Density rho_i = density::compute(prec, phi_i, spin);
@@ -157,6 +183,23 @@ void density::compute_local_X(double prec, Density &rho, OrbitalVector &Phi, Orb
 
     if (rho.Ncomp() == 0) rho.alloc(1);
 
+    if (density::fused_kernel_available(Phi) and density::fused_kernel_available(X)) {
+        std::vector<double> coefs;
+        std::vector<FunctionTree<3> *> bra, ket;
+        for (int i = 0; i < Phi.size(); i++) {
+            if (not mrcpp::mpi::my_func(Phi[i])) continue;
+            if (not mrcpp::mpi::my_func(X[i])) MSG_ABORT("Inconsistent MPI distribution");
+            double occ = density::compute_occupation(Phi[i], spin);
+            if (std::abs(occ) < mrcpp::MachineZero) continue;
+            coefs.push_back(2.0 * occ);
+            bra.push_back(&Phi[i].real());
+            ket.push_back(&X[i].real());
+        }
+        density::compute_products(mult_prec, rho, coefs, bra, ket);
+        rho.crop(add_prec);
+        return;
+    }
+
     // Compute local density from own orbitals
     for (int i = 0; i < Phi.size(); i++) {
         if (mrcpp::mpi::my_func(Phi[i])) {
@@ -181,9 +224,30 @@ void density::compute_local_XY(double prec, Density &rho, OrbitalVector &Phi, Or
     if (Phi.size() != Y.size()) MSG_ERROR("Size mismatch");
 
     if (rho.Ncomp() == 0) rho.alloc(1);
+    rho.real().setZero();
+
+    if (density::fused_kernel_available(Phi) and density::fused_kernel_available(X) and density::fused_kernel_available(Y)) {
+        std::vector<double> coefs;
+        std::vector<FunctionTree<3> *> bra, ket;
+        for (int i = 0; i < Phi.size(); i++) {
+            if (not mrcpp::mpi::my_func(Phi[i])) continue;
+            if (not mrcpp::mpi::my_func(X[i])) MSG_ABORT("Inconsistent MPI distribution");
+            if (not mrcpp::mpi::my_func(Y[i])) MSG_ABORT("Inconsistent MPI distribution");
+            double occ = density::compute_occupation(Phi[i], spin);
+            if (std::abs(occ) < mrcpp::MachineZero) continue;
+            coefs.push_back(occ);
+            bra.push_back(&Phi[i].real());
+            ket.push_back(&X[i].real());
+            coefs.push_back(occ);
+            bra.push_back(&Y[i].real());
+            ket.push_back(&Phi[i].real());
+        }
+        density::compute_products(mult_prec, rho, coefs, bra, ket);
+        rho.crop(add_prec);
+        return;
+    }
 
     // Compute local density from own orbitals
-    rho.real().setZero();
     for (int i = 0; i < Phi.size(); i++) {
         if (mrcpp::mpi::my_func(Phi[i])) {
             Orbital phi_i = Phi[i];
@@ -204,52 +268,121 @@ void density::compute_local_XY(double prec, Density &rho, OrbitalVector &Phi, Or
     }
 }
 
-void density::compute(double prec, Density &rho, mrcpp::GaussExp<3> &dens_exp) {
-    if (not rho.hasReal()) rho.alloc(1);
-    mrcpp::build_grid(rho.real(), dens_exp);
-    mrcpp::project(prec, rho.real(), dens_exp);
+/** @brief Check if the fused density kernel can be used for a set of orbitals
+ *
+ * The kernel handles real orbitals only, and is not used in numerically exact
+ * MPI runs, since its adaptive grid depends on the orbital distribution.
+ */
+bool density::fused_kernel_available(OrbitalVector &Phi) {
+    if (mrcpp::mpi::numerically_exact) return false;
+    for (auto &phi_i : Phi) {
+        if (not mrcpp::mpi::my_func(phi_i)) continue;
+        if (phi_i.iscomplex() or not phi_i.hasReal()) return false;
+    }
+    return true;
 }
 
-/** @brief Add up local density contributions and broadcast
+/** @brief Compute rho = sum_i c_i bra_i * ket_i in a single tree traversal
  *
- * MPI: Each rank first computes its own local density, which is then reduced
- *      to rank = 0 and broadcasted to all ranks.
+ * @param prec: relative precision used for adaptive grid refinement
+ * @param rho: output density, any existing content is kept and added to
+ * @param coefs: expansion coefficients c_i
+ * @param bra: real FunctionTrees bra_i
+ * @param ket: real FunctionTrees ket_i (may coincide with bra_i)
  *
+ * The output grid is initialized as the union grid of all input functions,
+ * which is built only once. The products are then summed pointwise node by
+ * node in an OpenMP parallel loop over the end nodes, in the same way the XC
+ * functional is evaluated in MRDFT. Nodes where the wavelet norm of the result
+ * is too large are refined, and only the end nodes created by the refinement
+ * are evaluated in the next pass, until the grid is converged.
  */
-void density::allreduce_density(double prec, Density &rho_tot, Density &rho_loc) {
-    // For numerically identical results in MPI we must first add
-    // up orbital contributions onto their union grid, and THEN
-    // crop the resulting density tree to the desired precision
-    double part_prec = (mrcpp::mpi::numerically_exact) ? -1.0 : prec;
-    // Add up local contributions into the grand master
-    mrcpp::mpi::reduce_function(part_prec, rho_loc, mrcpp::mpi::comm_wrk);
-    if (mrcpp::mpi::grand_master()) {
-        // If numerically exact the grid is huge at this point
-        if (mrcpp::mpi::numerically_exact) rho_loc.crop(prec);
-    }
+void density::compute_products(double prec, Density &rho, const std::vector<double> &coefs, std::vector<FunctionTree<3> *> &bra, std::vector<FunctionTree<3> *> &ket) {
+    if (bra.size() != coefs.size()) MSG_ERROR("Size mismatch");
+    if (ket.size() != coefs.size()) MSG_ERROR("Size mismatch");
+    if (coefs.size() == 0) return;
 
-    if (not rho_tot.hasReal()) rho_tot.alloc(1);
+    Density rho_loc(false);
+    rho_loc.alloc(1);
+    FunctionTree<3> &out = rho_loc.real();
+
+    // Build union grid once
+    for (int i = 0; i < coefs.size(); i++) {
+        mrcpp::build_grid(out, *bra[i]);
+        if (ket[i] != bra[i]) mrcpp::build_grid(out, *ket[i]);
+    }
 
-    if (rho_tot.isShared()) {
-        int tag = 2002;
-        if (mrcpp::mpi::share_master()) {
-            // MPI grand master distributes to shared masters
-            mrcpp::mpi::broadcast_function(rho_loc, mrcpp::mpi::comm_sh_group);
-            // MPI shared masters copies the function into final memory
-            mrcpp::copy_grid(rho_tot.real(), rho_loc.real());
-            mrcpp::copy_func(rho_tot.real(), rho_loc.real());
+    // End nodes that need to be evaluated, initially the whole union grid
+    std::vector<mrcpp::FunctionNode<3> *> todo;
+    for (int n = 0; n < out.getNEndNodes(); n++) todo.push_back(&out.getEndFuncNode(n));
+
+    while (todo.size() > 0) {
+#pragma omp parallel for schedule(guided)
+        for (int n = 0; n < todo.size(); n++) {
+            auto &out_node = *todo[n];
+            auto idx = out_node.getNodeIndex();
+
+            Eigen::VectorXd out_vals = Eigen::VectorXd::Zero(out_node.getNCoefs());
+            Eigen::VectorXd bra_vals, ket_vals;
+            for (int i = 0; i < coefs.size(); i++) {
+                // missing nodes are generated on the fly from the coarser input trees
+                static_cast<mrcpp::FunctionNode<3> &>(bra[i]->getNode(idx)).getValues(bra_vals);
+                if (ket[i] != bra[i]) {
+                    static_cast<mrcpp::FunctionNode<3> &>(ket[i]->getNode(idx)).getValues(ket_vals);
+                    out_vals += coefs[i] * bra_vals.cwiseProduct(ket_vals);
+                } else {
+                    out_vals += coefs[i] * bra_vals.cwiseAbs2();
+                }
+            }
+            out_node.setValues(out_vals);
         }
-        // MPI share masters distributes to their sharing ranks
-        mrcpp::mpi::share_function(rho_tot, 0, tag, mrcpp::mpi::comm_share);
+        out.mwTransform(mrcpp::BottomUp);
+        out.calcSquareNorm();
+
+        // Nodes are only added by the refinement, so the new end nodes are
+        // the ones that were not end nodes before
+        std::set<const mrcpp::FunctionNode<3> *> old_nodes;
+        for (int n = 0; n < out.getNEndNodes(); n++) old_nodes.insert(&out.getEndFuncNode(n));
+        todo.clear();
+        if (mrcpp::refine_grid(out, prec) > 0) {
+            for (int n = 0; n < out.getNEndNodes(); n++) {
+                auto *node = &out.getEndFuncNode(n);
+                if (old_nodes.count(node) == 0) todo.push_back(node);
+            }
+        }
+    }
+
+    // Remove temporary nodes generated in the input trees
+    for (int i = 0; i < coefs.size(); i++) {
+        bra[i]->deleteGenerated();
+        ket[i]->deleteGenerated();
+    }
+
+    if (rho.hasReal()) {
+        rho.add(1.0, rho_loc);
+        rho_loc.free();
     } else {
-        // MPI grand master distributes to all ranks
-        mrcpp::mpi::broadcast_function(rho_loc, mrcpp::mpi::comm_wrk);
-        // All MPI ranks copies the function into final memory
-        mrcpp::copy_grid(rho_tot.real(), rho_loc.real());
-        mrcpp::copy_func(rho_tot.real(), rho_loc.real());
+        rho = rho_loc;
     }
 }
 
+void density::compute(double prec, Density &rho, mrcpp::GaussExp<3> &dens_exp) {
+    if (not rho.hasReal()) rho.alloc(1);
+    mrcpp::build_grid(rho.real(), dens_exp);
+    mrcpp::project(prec, rho.real(), dens_exp);
+}
+
+/** @brief Add up local density contributions and distribute
+ *
+ * MPI: The local densities are summed up and distributed to all ranks by
+ *      mpi_utils::allreduce_function(), which does not pass the full density
+ *      through the grand master (except in numerically exact runs).
+ *
+ */
+void density::allreduce_density(double prec, Density &rho_tot, Density &rho_loc) {
+    mpi_utils::allreduce_function(prec, rho_tot, rho_loc, 2002);
+}
+
 // Function to read atomic density data from a file
 void density::readAtomicDensity(const std::string path, Eigen::VectorXd &rGrid, Eigen::VectorXd &rhoGrid) {
     std::vector<double> r, rho;
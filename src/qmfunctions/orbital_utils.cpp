@@ -23,6 +23,7 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <array>
 #include <fstream>
 
 #include <MRCPP/Printer>
@@ -30,6 +31,7 @@
 #include <MRCPP/trees/FunctionNode.h>
 #include <MRCPP/utils/details.h>
 
+#include "utils/JacobiLocalizer.h"
 #include "utils/RRMaximizer.h"
 #include "utils/math_utils.h"
 #include "utils/print_utils.h"
@@ -46,8 +48,11 @@ namespace mrchem {
 extern mrcpp::MultiResolutionAnalysis<3> *MRA; // Global MRA
 
 namespace orbital {
-ComplexMatrix localize(double prec, OrbitalVector &Phi, int spin);
+ComplexMatrix localize(double prec, OrbitalVector &Phi, int spin, bool jacobi);
+ComplexMatrix localize_jacobi(double prec, OrbitalVector &Phi);
 ComplexMatrix calc_localization_matrix(double prec, OrbitalVector &Phi);
+OrbitalVector extract(OrbitalVector &Phi, const std::vector<int> &idx);
+void insert(OrbitalVector &Phi, OrbitalVector &Phi_sub, const std::vector<int> &idx);
 
 /* POD struct for orbital meta data. Used for simple MPI communication. */
 struct OrbitalData {
@@ -62,6 +67,16 @@ OrbitalData getOrbitalData(const Orbital &orb) {
     orb_data.occ = orb.occ();
     return orb_data;
 }
+
+/* Gauss-Legendre rule on the unit interval, as used for the child points of a node. */
+struct MomentQuadrature {
+    DoubleVector roots;
+    DoubleVector weights;
+};
+MomentQuadrature make_moment_quadrature(int n_pts);
+void calc_moments(mrcpp::FunctionTree<3> &bra, mrcpp::FunctionTree<3> &ket, const MomentQuadrature &quad, int order, DoubleVector &moments);
+void calc_moments(FunctionNode<3> &bra, FunctionNode<3> &ket, const MomentQuadrature &quad, int order, DoubleVector &moments);
+void calc_leaf_moments(FunctionNode<3> &leaf, FunctionNode<3> &fine, const MomentQuadrature &quad, int order, DoubleVector &moments);
 } // namespace orbital
 
 /****************************************
@@ -487,6 +502,141 @@ ComplexMatrix orbital::calc_overlap_matrix(OrbitalVector &Bra, OrbitalVector &Ke
     return mrcpp::calc_overlap_matrix(Bra, Ket);
 }
 
+/** @brief Compute the first (and second) moment matrices of real orbitals
+ *
+ * @param Phi: orbitals, must be real
+ * @param order: 1 for <i|x|j>, <i|y|j>, <i|z|j>; 2 adds <i|xx|j>, <i|xy|j>,
+ *               <i|xz|j>, <i|yy|j>, <i|yz|j>, <i|zz|j>
+ *
+ * All moments of an orbital pair are accumulated in one joint traversal of the
+ * two trees, directly from the node values in the quadrature points. No
+ * operator is applied and no intermediate function is built. Where one tree
+ * is refined further than the other, the coarse leaf is evaluated in the
+ * points of the fine nodes. The (k+1)-point quadrature of an MRA of order k
+ * is exact up to polynomial degree 2k+1 in each direction. The first moments
+ * and the off-diagonal second moments are thus exact for the MW
+ * representation. The diagonal second moments (xx, yy, zz) integrate a
+ * polynomial of degree 2k+2, and are approximate with an error from the
+ * finest nodes only.
+ *
+ * MPI: each orbital is sent once to every rank that owns an orbital with a
+ *      larger index, only the lower triangle is computed.
+ */
+std::vector<DoubleMatrix> orbital::calc_moment_matrices(OrbitalVector &Phi, int order) {
+    if (order < 1 or order > 2) MSG_ABORT("Invalid moment order");
+    int N = Phi.size();
+    int n_moms = (order == 1) ? 3 : 9;
+    std::vector<DoubleMatrix> R(n_moms, DoubleMatrix::Zero(N, N));
+
+    auto quad = orbital::make_moment_quadrature(MRA->getOrder() + 1);
+    for (int j = 0; j < N; j++) {
+        if (Phi[j].iscomplex()) MSG_ABORT("Moment matrices require real orbitals");
+        int src = Phi[j].getRank() % mrcpp::mpi::wrk_size;
+        for (int dst = 0; dst < mrcpp::mpi::wrk_size; dst++) {
+            if (dst == src) continue;
+            bool needed = false;
+            for (int i = j + 1; i < N; i++) needed = needed or (Phi[i].getRank() % mrcpp::mpi::wrk_size == dst);
+            if (not needed) continue;
+            if (mrcpp::mpi::wrk_rank == src) mrcpp::mpi::send_function(Phi[j], dst, j, mrcpp::mpi::comm_wrk);
+            if (mrcpp::mpi::wrk_rank == dst) mrcpp::mpi::recv_function(Phi[j], src, j, mrcpp::mpi::comm_wrk);
+        }
+        for (int i = j; i < N; i++) {
+            if (not mrcpp::mpi::my_func(Phi[i])) continue;
+            DoubleVector moms = DoubleVector::Zero(n_moms);
+            orbital::calc_moments(Phi[i].real(), Phi[j].real(), quad, order, moms);
+            for (int k = 0; k < n_moms; k++) {
+                R[k](i, j) = moms(k);
+                R[k](j, i) = moms(k);
+            }
+        }
+        if (not mrcpp::mpi::my_func(Phi[j])) Phi[j].free();
+    }
+    for (auto &R_k : R) mrcpp::mpi::allreduce_matrix(R_k, mrcpp::mpi::comm_wrk);
+    return R;
+}
+
+/** @brief Gauss-Legendre roots and weights on [0,1] (Golub-Welsch). Private function. */
+orbital::MomentQuadrature orbital::make_moment_quadrature(int n_pts) {
+    DoubleMatrix J = DoubleMatrix::Zero(n_pts, n_pts);
+    for (int k = 1; k < n_pts; k++) {
+        J(k, k - 1) = k / std::sqrt(4.0 * k * k - 1.0);
+        J(k - 1, k) = J(k, k - 1);
+    }
+    Eigen::SelfAdjointEigenSolver<DoubleMatrix> es(J);
+    MomentQuadrature quad;
+    quad.roots = 0.5 * (es.eigenvalues().array() + 1.0);
+    quad.weights = es.eigenvectors().row(0).transpose().array().square();
+    return quad;
+}
+
+/** @brief Moments of a pair of trees, summed over the root nodes. Private function. */
+void orbital::calc_moments(mrcpp::FunctionTree<3> &bra, mrcpp::FunctionTree<3> &ket, const MomentQuadrature &quad, int order, DoubleVector &moments) {
+    for (int n = 0; n < bra.getRootBox().size(); n++) orbital::calc_moments(bra.getRootFuncNode(n), ket.getRootFuncNode(n), quad, order, moments);
+
+    // Remove temporary nodes generated when evaluating coarse leaves
+    bra.deleteGenerated();
+    ket.deleteGenerated();
+}
+
+/** @brief Moments of a pair of nodes, descending until one of them is a leaf. Private function. */
+void orbital::calc_moments(FunctionNode<3> &bra, FunctionNode<3> &ket, const MomentQuadrature &quad, int order, DoubleVector &moments) {
+    if (bra.isBranchNode() and ket.isBranchNode()) {
+        for (int c = 0; c < bra.getTDim(); c++) orbital::calc_moments(bra.getFuncChild(c), ket.getFuncChild(c), quad, order, moments);
+    } else if (bra.isLeafNode()) {
+        orbital::calc_leaf_moments(bra, ket, quad, order, moments);
+    } else {
+        orbital::calc_leaf_moments(ket, bra, quad, order, moments);
+    }
+}
+
+/** @brief Moments of a leaf node with all leaves below the other node. Private function.
+ *
+ * Integrates in the child quadrature points of the fine leaves, where both
+ * functions are polynomials of the MRA order. The points of each child are
+ * the tensor product of the 1D quadrature roots, so the weight of a point is
+ * the product of the 1D weights of its tensor indices.
+ */
+void orbital::calc_leaf_moments(FunctionNode<3> &leaf, FunctionNode<3> &fine, const MomentQuadrature &quad, int order, DoubleVector &moments) {
+    if (fine.isBranchNode()) {
+        for (int c = 0; c < fine.getTDim(); c++) orbital::calc_leaf_moments(leaf, fine.getFuncChild(c), quad, order, moments);
+        return;
+    }
+    const auto sf = MRA->getWorldBox().getScalingFactors();
+    DoubleMatrix pts;
+    fine.getExpandedChildPts(pts);
+    DoubleVector fine_vals, leaf_vals;
+    fine.getValues(fine_vals);
+    if (leaf.getScale() == fine.getScale()) {
+        leaf.getValues(leaf_vals);
+    } else {
+        leaf_vals = DoubleVector(pts.cols());
+        for (int p = 0; p < pts.cols(); p++) leaf_vals(p) = leaf.evalf({pts(0, p), pts(1, p), pts(2, p)});
+    }
+
+    int kp1 = fine.getKp1();
+    int kp1_d = fine.getKp1_d();
+    if (quad.weights.size() != kp1) MSG_ABORT("Invalid moment quadrature");
+
+    double two_n = std::pow(2.0, fine.getScale() + 1);
+    for (int p = 0; p < pts.cols(); p++) {
+        // tensor indices of the point within its child box
+        int t = p % kp1_d;
+        std::array<int, 3> q = {t % kp1, (t / kp1) % kp1, t / (kp1 * kp1)};
+        double w_p = leaf_vals(p) * fine_vals(p);
+        mrcpp::Coord<3> r_p;
+        for (int d = 0; d < 3; d++) {
+            w_p *= quad.weights(q[d]) / two_n;
+            r_p[d] = pts(d, p) * sf[d];
+        }
+        for (int d = 0; d < 3; d++) moments(d) += w_p * r_p[d];
+        if (order < 2) continue;
+        int k = 3;
+        for (int d = 0; d < 3; d++) {
+            for (int e = d; e < 3; e++) moments(k++) += w_p * r_p[d] * r_p[e];
+        }
+    }
+}
+
 /** @brief Compute Löwdin orthonormalization matrix
  *
  * @param Phi: orbitals to orthonomalize
@@ -503,7 +653,7 @@ ComplexMatrix orbital::calc_lowdin_matrix(OrbitalVector &Phi) {
     return S_m12;
 }
 
-ComplexMatrix orbital::localize(double prec, OrbitalVector &Phi, ComplexMatrix &F) {
+ComplexMatrix orbital::localize(double prec, OrbitalVector &Phi, ComplexMatrix &F, bool jacobi) {
     Timer t_tot;
     auto plevel = Printer::getPrintLevel();
     mrcpp::print::header(2, "Localizing orbitals");
@@ -516,9 +666,9 @@ ComplexMatrix orbital::localize(double prec, OrbitalVector &Phi, ComplexMatrix &
     int nA = size_alpha(Phi);
     int nB = size_beta(Phi);
     ComplexMatrix U = ComplexMatrix::Identity(nO, nO);
-    if (nP > 0) U.block(0, 0, nP, nP) = localize(prec, Phi, SPIN::Paired);
-    if (nA > 0) U.block(nP, nP, nA, nA) = localize(prec, Phi, SPIN::Alpha);
-    if (nB > 0) U.block(nP + nA, nP + nA, nB, nB) = localize(prec, Phi, SPIN::Beta);
+    if (nP > 0) U.block(0, 0, nP, nP) = localize(prec, Phi, SPIN::Paired, jacobi);
+    if (nA > 0) U.block(nP, nP, nA, nA) = localize(prec, Phi, SPIN::Alpha, jacobi);
+    if (nB > 0) U.block(nP + nA, nP + nA, nB, nB) = localize(prec, Phi, SPIN::Beta, jacobi);
 
     // Transform Fock matrix
     F = U.adjoint() * F * U;
@@ -536,16 +686,113 @@ Localization is done for each set of spins separately (we don't want to mix spin
 The localization matrix is returned for further processing.
 
 */
-ComplexMatrix orbital::localize(double prec, OrbitalVector &Phi, int spin) {
+ComplexMatrix orbital::localize(double prec, OrbitalVector &Phi, int spin, bool jacobi) {
     OrbitalVector Phi_s = orbital::disjoin(Phi, spin);
-    ComplexMatrix U = calc_localization_matrix(prec, Phi_s);
-    Timer rot_t;
-    mrcpp::rotate(Phi_s, U, prec);
+    bool all_real = true;
+    for (auto &phi_i : Phi_s) all_real = all_real and phi_i.isreal();
+    ComplexMatrix U;
+    if (jacobi and all_real and Phi_s.size() > 1) {
+        U = localize_jacobi(prec, Phi_s);
+    } else {
+        U = calc_localization_matrix(prec, Phi_s);
+        Timer rot_t;
+        mrcpp::rotate(Phi_s, U, prec);
+        mrcpp::print::time(2, "Rotating orbitals", rot_t);
+    }
     Phi = orbital::adjoin(Phi, Phi_s);
-    mrcpp::print::time(2, "Rotating orbitals", rot_t);
     return U;
 }
 
+/** @brief Localize orthonormal orbitals by Jacobi sweeps. Private function.
+ *
+ * @param Phi: orbitals to localize, of the same spin, real and orthonormal
+ *
+ * Unlike calc_localization_matrix, the orbitals are not orthonormalized, so
+ * the transformation is a product of plane rotations. Only the orbitals that
+ * take part in at least one rotation are rotated, the rest are left as they
+ * are. Orbitals are rotated in place, and the transformation matrix is returned.
+ */
+ComplexMatrix orbital::localize_jacobi(double prec, OrbitalVector &Phi) {
+    Timer rmat_t;
+    JacobiLocalizer jl(prec, Phi);
+    mrcpp::print::time(2, "Computing position matrices", rmat_t);
+
+    Timer jl_t;
+    int n_sweeps = jl.localize();
+    mrcpp::print::time(2, "Computing Jacobi sweeps", jl_t);
+    if (n_sweeps > 0) {
+        println(2, " Foster-Boys localization converged in " << n_sweeps << " sweeps!");
+    } else {
+        println(2, " Foster-Boys localization did not converge!");
+    }
+
+    Timer rot_t;
+    const DoubleMatrix &U = jl.getTotalU();
+    std::vector<int> idx = jl.getRotatedIndices();
+    println(2, " Rotating " << idx.size() << " of " << Phi.size() << " orbitals");
+    if (idx.size() == Phi.size()) {
+        mrcpp::rotate(Phi, U.cast<ComplexDouble>(), prec);
+    } else if (idx.size() > 0) {
+        ComplexMatrix U_sub(idx.size(), idx.size());
+        for (int a = 0; a < idx.size(); a++) {
+            for (int b = 0; b < idx.size(); b++) U_sub(a, b) = U(idx[a], idx[b]);
+        }
+        OrbitalVector Phi_sub = orbital::extract(Phi, idx);
+        mrcpp::rotate(Phi_sub, U_sub, prec);
+        orbital::insert(Phi, Phi_sub, idx);
+    }
+    mrcpp::print::time(2, "Rotating orbitals", rot_t);
+    return U.cast<ComplexDouble>();
+}
+
+/** @brief Collect a subset of orbitals into a new vector. Private function.
+ *
+ * The orbitals are new copies, redistributed according to their position in
+ * the new vector. The input orbitals keep their rank and data.
+ */
+OrbitalVector orbital::extract(OrbitalVector &Phi, const std::vector<int> &idx) {
+    OrbitalVector out;
+    for (int i : idx) {
+        int k = out.size();
+        Orbital phi_k;
+        phi_k.func_ptr->data = Phi[i].func_ptr->data;
+        if (i % mrcpp::mpi::wrk_size == k % mrcpp::mpi::wrk_size) {
+            if (mrcpp::mpi::my_func(i)) mrcpp::deep_copy(phi_k, Phi[i]);
+        } else {
+            // need to send orbital from owner to new owner
+            if (mrcpp::mpi::my_func(i)) { mrcpp::mpi::send_function(Phi[i], k % mrcpp::mpi::wrk_size, i, mrcpp::mpi::comm_wrk); }
+            if (mrcpp::mpi::my_func(k)) { mrcpp::mpi::recv_function(phi_k, i % mrcpp::mpi::wrk_size, i, mrcpp::mpi::comm_wrk); }
+        }
+        phi_k.setRank(k);
+        out.push_back(phi_k);
+    }
+    return out;
+}
+
+/** @brief Put back a subset of orbitals collected with extract. Private function.
+ *
+ * The orbitals of Phi_sub replace those of Phi at the given indices. Phi_sub
+ * is consumed: its orbitals are moved into Phi, or sent to their new owner.
+ */
+void orbital::insert(OrbitalVector &Phi, OrbitalVector &Phi_sub, const std::vector<int> &idx) {
+    for (int k = 0; k < idx.size(); k++) {
+        int i = idx[k];
+        Orbital phi_i;
+        phi_i.func_ptr->data = Phi_sub[k].func_ptr->data;
+        if (i % mrcpp::mpi::wrk_size == k % mrcpp::mpi::wrk_size) {
+            phi_i = Phi_sub[k];
+        } else {
+            // need to send orbital from owner to new owner
+            if (mrcpp::mpi::my_func(k)) { mrcpp::mpi::send_function(Phi_sub[k], i % mrcpp::mpi::wrk_size, k, mrcpp::mpi::comm_wrk); }
+            if (mrcpp::mpi::my_func(i)) { mrcpp::mpi::recv_function(phi_i, k % mrcpp::mpi::wrk_size, k, mrcpp::mpi::comm_wrk); }
+        }
+        phi_i.setRank(i);
+        Phi[i] = phi_i;
+    }
+    Phi_sub.clear();
+    mrcpp::mpi::free_foreign(Phi);
+}
+
 /** @brief Minimize the spatial extension of orbitals, by orbital rotation
  *
  * @param Phi: orbitals to localize (they should all be of the same spin)
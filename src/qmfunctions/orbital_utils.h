@@ -61,8 +61,9 @@ void orthogonalize(double prec, OrbitalVector &Phi, OrbitalVector &Psi);
 ComplexMatrix calc_lowdin_matrix(OrbitalVector &Phi);
 ComplexMatrix calc_overlap_matrix(OrbitalVector &BraKet);
 ComplexMatrix calc_overlap_matrix(OrbitalVector &Bra, OrbitalVector &Ket);
+std::vector<DoubleMatrix> calc_moment_matrices(OrbitalVector &Phi, int order = 1);
 
-ComplexMatrix localize(double prec, OrbitalVector &Phi, ComplexMatrix &F);
+ComplexMatrix localize(double prec, OrbitalVector &Phi, ComplexMatrix &F, bool jacobi = false);
 ComplexMatrix diagonalize(double prec, OrbitalVector &Phi, ComplexMatrix &F);
 ComplexMatrix orthonormalize(double prec, OrbitalVector &Phi, ComplexMatrix &F);
 
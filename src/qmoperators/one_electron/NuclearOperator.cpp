@@ -43,6 +43,7 @@
 #include "qmfunctions/Density.h"
 #include "qmoperators/QMPotential.h"
 #include "utils/math_utils.h"
+#include "utils/mpi_utils.h"
 #include "utils/print_utils.h"
 
 using mrcpp::Printer;
@@ -97,6 +98,9 @@ NuclearOperator::NuclearOperator(const Nuclei &nucs, double proj_prec, double sm
     vol = std::max(1.0, vol);        // do not scale for smaller boxes
     loc_prec /= pow(vol, 1.0 / 6.0); // norm of 1/r over the box ~ root_6(Volume)
 
+    // Evaluate smoothing only for nearby nuclei
+    f_loc->setupScreening();
+
     // Project local potential
     mrcpp::CompFunction<3> V_loc(false);
     mrcpp::project(V_loc, *f_loc, loc_prec);
@@ -162,32 +166,7 @@ void NuclearOperator::setupLocalPotential(NuclearFunction &f_loc, const Nuclei &
 }
 
 void NuclearOperator::allreducePotential(double prec, mrcpp::CompFunction<3> &V_tot, mrcpp::CompFunction<3> &V_loc) const {
-    // Add up local contributions into the grand master
-    mrcpp::mpi::reduce_function(prec, V_loc, mrcpp::mpi::comm_wrk);
-    if (mrcpp::mpi::grand_master()) {
-        // If numerically exact the grid is huge at this point
-        if (mrcpp::mpi::numerically_exact) V_loc.crop(prec);
-    }
-
-    if (not V_tot.hasReal()) V_tot.alloc(1);
-    if (V_tot.isShared()) {
-        int tag = 3141;
-        // MPI grand master distributes to shared masters
-        mrcpp::mpi::broadcast_function(V_loc, mrcpp::mpi::comm_sh_group);
-        if (mrcpp::mpi::share_master()) {
-            // MPI shared masters copies the function into final memory
-            mrcpp::copy_grid(V_tot.real(), V_loc.real());
-            mrcpp::copy_func(V_tot.real(), V_loc.real());
-        }
-        // MPI share masters distributes to their sharing ranks
-        mrcpp::mpi::share_function(V_tot, 0, tag, mrcpp::mpi::comm_share);
-    } else {
-        // MPI grand master distributes to all ranks
-        mrcpp::mpi::broadcast_function(V_loc, mrcpp::mpi::comm_wrk);
-        // All MPI ranks copies the function into final memory
-        mrcpp::copy_grid(V_tot.real(), V_loc.real());
-        mrcpp::copy_func(V_tot.real(), V_loc.real());
-    }
+    mpi_utils::allreduce_function(prec, V_tot, V_loc, 3141);
 }
 
 } // namespace mrchem
@@ -71,6 +71,11 @@ public:
 
     auto &getPoisson() { return this->potential->getPoisson(); }
     auto &getDensity() { return this->potential->getDensity(); }
+    void setDensityCache(std::shared_ptr<DensityCache> cache) { this->potential->setDensityCache(cache); }
+    void setRefreshInterval(int interval) { this->potential->setRefreshInterval(interval); }
+    void setDistributed(bool distribute) { this->potential->setDistributed(distribute); }
+    void savePotential(const std::string &file) { this->potential->savePotential(file); }
+    bool loadPotential(double prec, const std::string &file) { return this->potential->loadPotential(prec, file); }
 
 private:
     std::shared_ptr<CoulombPotential> potential{nullptr};
@@ -23,13 +23,19 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <fstream>
+
 #include "CoulombPotential.h"
+#include "MRCPP/MWFunctions"
 #include "MRCPP/MWOperators"
+#include "MRCPP/Parallel"
 #include "MRCPP/Printer"
 #include "MRCPP/Timer"
+#include "MRCPP/trees/FunctionNode.h"
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/density_utils.h"
 #include "qmfunctions/orbital_utils.h"
+#include "utils/mpi_utils.h"
 #include "utils/print_utils.h"
 
 using mrcpp::Printer;
@@ -55,8 +61,11 @@ namespace mrchem {
 CoulombPotential::CoulombPotential(PoissonOperator_p P, OrbitalVector_p Phi, bool mpi_share)
         : QMPotential(1, mpi_share)
         , density(false)
+        , previous_density(false)
+        , previous_pot(false)
         , orbitals(Phi)
-        , poisson(P) {}
+        , poisson(P)
+        , density_cache(nullptr) {}
 
 /** @brief prepare operator for application
  *
@@ -65,6 +74,9 @@ CoulombPotential::CoulombPotential(PoissonOperator_p P, OrbitalVector_p Phi, boo
  * This will compute the Coulomb potential by application of the Poisson
  * operator to the density. If the density is not available it is computed
  * from the current orbitals (assuming that the orbitals are available).
+ * If a DensityCache is attached, the (global) density is borrowed from the
+ * cache instead of being recomputed. In distributed mode the total density
+ * is always used, and the Poisson application is split over the MPI ranks.
  * For first-order perturbations the first order density and the Hessian will be
  * computed. In order to make the Hessian available to CoulombOperator, it is stored in the
  * potential function instead of the zeroth-order potential.
@@ -78,7 +90,12 @@ void CoulombPotential::setup(double prec) {
     mrcpp::print::header(3, "Building Coulomb operator");
     mrcpp::print::value(3, "Precision", prec, "(rel)", 5);
     mrcpp::print::separator(3, '-');
-    if (hasDensity()) {
+    if (not hasDensity()) borrowDensity(prec);
+    if (useDistributedPotential()) {
+        setupGlobalDensity(prec);
+        mrcpp::CompFunction<3> V = setupDistributedPotential(prec);
+        allreducePotential(prec, V);
+    } else if (hasDensity()) {
         setupGlobalPotential(prec);
     } else if (mrcpp::mpi::numerically_exact) {
         setupGlobalDensity(prec);
@@ -97,12 +114,73 @@ void CoulombPotential::setup(double prec) {
 /** @brief clear operator after application
  *
  * This will clear the operator and bring it back to the state after construction.
- * The operator can now be reused after another setup.
+ * The operator can now be reused after another setup. The copies kept for
+ * incremental updates are NOT cleared here, see clearPrevious().
  */
 void CoulombPotential::clear() {
     mrcpp::CompFunction<3>::free(); // delete FunctionTree pointers
-    this->density.free();           // delete FunctionTree pointers
-    clearApplyPrec();               // apply_prec = -1
+    if (this->borrowed_density) {
+        this->density = Density(false); // trees are owned by the cache
+    } else {
+        this->density.free(); // delete FunctionTree pointers
+    }
+    this->borrowed_density = false;
+    clearApplyPrec(); // apply_prec = -1
+}
+
+/** @brief write the potential to disk
+ *
+ * @param file: file name of the potential tree
+ *
+ * The operator must be set up. The apply precision is written to
+ * "<file>.meta", such that loadPotential() can check it.
+ */
+void CoulombPotential::savePotential(const std::string &file) {
+    if (prec() < 0.0) MSG_ERROR("Coulomb operator not set up");
+    double apply_prec = prec();
+
+    std::fstream f;
+    f.open(file + ".meta", std::ios::out | std::ios::binary);
+    if (not f.is_open()) MSG_ERROR("Unable to open file");
+    f.write((char *)&apply_prec, sizeof(double));
+    f.close();
+
+    CompD[0]->saveTree(file);
+}
+
+/** @brief read a potential written by savePotential()
+ *
+ * @param prec: apply precision requested for the potential
+ * @param file: file name of the potential tree
+ *
+ * The potential is only read if it was computed with the requested or a
+ * tighter precision. The operator is then considered set up at the given
+ * precision, such that the next setup() with this precision will not
+ * recompute the potential. The potential is released as usual in clear().
+ *
+ * @returns whether the potential was read
+ */
+bool CoulombPotential::loadPotential(double prec, const std::string &file) {
+    mrcpp::CompFunction<3> &V = *this;
+    if (V.getNNodes() > 8) MSG_ERROR("Potential not properly cleared");
+
+    double save_prec = -1.0;
+    std::fstream f;
+    f.open(file + ".meta", std::ios::in | std::ios::binary);
+    if (f.is_open()) f.read((char *)&save_prec, sizeof(double));
+    f.close();
+    if (save_prec <= 0.0 or save_prec > prec) {
+        MSG_WARN("Stored Coulomb potential not computed with requested precision");
+        return false;
+    }
+
+    Timer timer;
+    V.alloc(1);
+    if (not(V.isShared()) or mrcpp::mpi::share_master()) V.CompD[0]->loadTree(file);
+    mrcpp::mpi::share_function(V, 0, 22445, mrcpp::mpi::comm_share);
+    setApplyPrec(prec);
+    print_utils::qmfunction(3, "Read global potential", V, timer);
+    return true;
 }
 
 /** @brief compute Coulomb potential
@@ -127,11 +205,99 @@ void CoulombPotential::setupGlobalPotential(double prec) {
 
     Timer timer;
     V.alloc(1);
-    if (need_to_apply) mrcpp::apply(abs_prec, V.real(), P, rho.real());
+    if (need_to_apply) {
+        if (not setupIncrementalPotential(prec)) {
+            mrcpp::apply(abs_prec, V.real(), P, rho.real());
+            this->incremental_steps = 0;
+            this->previous_prec = prec;
+            storePotential();
+        }
+    }
     mrcpp::mpi::share_function(V, 0, 22445, mrcpp::mpi::comm_share);
     print_utils::qmfunction(3, "Compute global potential", V, timer);
 }
 
+/** @brief update Coulomb potential from the previous density and potential
+ *
+ * @param prec: apply precision
+ * @returns true if the potential was updated, false if a full rebuild is needed
+ *
+ * Computes V = V_prev + P(rho - rho_prev). The Poisson operator is applied to
+ * the density difference with a precision that is relaxed by its norm, such
+ * that the absolute error is comparable to a full application on rho. If the
+ * difference is below the precision the previous potential is reused as is,
+ * and the stored density is kept such that small changes are not lost.
+ * A full rebuild is requested when incremental mode is off, when no previous
+ * potential is available, when the refresh interval is reached, or when the
+ * stored potential was computed at a looser precision than requested.
+ */
+bool CoulombPotential::setupIncrementalPotential(double prec) {
+    if (this->refresh_interval <= 0) return false;
+    if (this->previous_prec <= 0.0) return false;
+    if (this->previous_prec > prec) return false;
+    if (this->incremental_steps + 1 >= this->refresh_interval) return false;
+
+    PoissonOperator &P = *this->poisson;
+    mrcpp::CompFunction<3> &V = *this;
+    mrcpp::CompFunction<3> &rho = this->density;
+
+    Timer timer;
+    mrcpp::CompFunction<3> delta_rho;
+    mrcpp::add(delta_rho, 1.0, rho, -1.0, this->previous_density, -1.0);
+    double delta_norm = delta_rho.norm();
+
+    if (delta_norm <= prec) {
+        delta_rho.free();
+        mrcpp::copy_grid(V.real(), this->previous_pot.real());
+        mrcpp::copy_func(V.real(), this->previous_pot.real());
+        print_utils::qmfunction(3, "Reused potential", V, timer);
+        return true;
+    }
+
+    mrcpp::CompFunction<3> delta_V(false);
+    delta_V.alloc(1);
+    mrcpp::apply(prec / delta_norm, delta_V.real(), P, delta_rho.real());
+    delta_rho.free();
+
+    double abs_prec = prec / rho.norm();
+    mrcpp::add(-1.0, V.real(), 1.0, this->previous_pot.real(), 1.0, delta_V.real());
+    V.crop(abs_prec);
+    delta_V.free();
+
+    this->incremental_steps++;
+    storePotential();
+    print_utils::qmfunction(3, "Incremental potential", V, timer);
+    return true;
+}
+
+/** @brief keep copies of the current density and potential for the next setup
+ *
+ * Nothing is stored unless incremental mode is switched on.
+ */
+void CoulombPotential::storePotential() {
+    if (this->refresh_interval <= 0) return;
+    this->previous_density.free();
+    this->previous_pot.free();
+
+    Density rho_prev(false);
+    mrcpp::CompFunction<3> V_prev(false);
+    mrcpp::deep_copy(rho_prev, this->density);
+    mrcpp::deep_copy(V_prev, *this);
+    this->previous_density = rho_prev;
+    this->previous_pot = V_prev;
+}
+
+/** @brief delete the density and potential kept for incremental updates
+ *
+ * The next setup() will do a full rebuild of the potential.
+ */
+void CoulombPotential::clearPrevious() {
+    this->previous_density.free();
+    this->previous_pot.free();
+    this->previous_prec = -1.0;
+    this->incremental_steps = 0;
+}
+
 /** @brief compute Coulomb potential
  *
  * @param prec: apply precision
@@ -158,6 +324,87 @@ mrcpp::CompFunction<3> CoulombPotential::setupLocalPotential(double prec) {
     return V;
 }
 
+/** @brief check if the Poisson application should be split over MPI ranks
+ *
+ * Only meaningful in non-exact MPI runs where the orbitals are available,
+ * since the sum over ranks requires the electron number for its precision.
+ */
+bool CoulombPotential::useDistributedPotential() const {
+    if (not this->distributed) return false;
+    if (this->orbitals == nullptr) return false;
+    if (mrcpp::mpi::numerically_exact) return false;
+    return (mrcpp::mpi::wrk_size > 1);
+}
+
+/** @brief compute this rank's part of the Coulomb potential
+ *
+ * @param prec: apply precision
+ *
+ * The end nodes of the total density are divided into wrk_size contiguous
+ * chunks, which in the tree ordering correspond to spatially compact
+ * subtrees. Each rank keeps the coefficients of its own chunk, zeroes the
+ * rest, and applies the Poisson operator to this partial density. By
+ * linearity the sum of the partial potentials over all ranks is the full
+ * potential (see allreducePotential()). Each part is computed such that
+ * the accumulated error of the sum corresponds to the requested precision.
+ */
+mrcpp::CompFunction<3> CoulombPotential::setupDistributedPotential(double prec) {
+    if (this->poisson == nullptr) MSG_ERROR("Poisson operator not initialized");
+
+    PoissonOperator &P = *this->poisson;
+    mrcpp::CompFunction<3> &rho = this->density;
+    int wrk_rank = mrcpp::mpi::wrk_rank;
+    int wrk_size = mrcpp::mpi::wrk_size;
+
+    Timer timer;
+    mrcpp::CompFunction<3> rho_loc(false);
+    rho_loc.alloc(1);
+    mrcpp::FunctionTree<3> &rho_tot = rho.real();
+    mrcpp::FunctionTree<3> &rho_part = rho_loc.real();
+    mrcpp::copy_grid(rho_part, rho_tot);
+
+    int nNodes = rho_part.getNEndNodes();
+    int first = (wrk_rank * nNodes) / wrk_size;
+    int last = ((wrk_rank + 1) * nNodes) / wrk_size;
+#pragma omp parallel for schedule(guided)
+    for (int n = 0; n < nNodes; n++) {
+        auto &part_node = rho_part.getEndFuncNode(n);
+        Eigen::VectorXd vals = Eigen::VectorXd::Zero(part_node.getNCoefs());
+        if (n >= first and n < last) {
+            auto idx = part_node.getNodeIndex();
+            static_cast<mrcpp::FunctionNode<3> &>(rho_tot.getNode(idx)).getValues(vals);
+        }
+        part_node.setValues(vals);
+    }
+    rho_part.mwTransform(mrcpp::BottomUp);
+    rho_part.calcSquareNorm();
+
+    // Remove the zeroed regions outside this rank's part
+    double part_norm = rho_loc.norm();
+    if (part_norm > 0.0) rho_loc.crop(prec);
+    print_utils::qmfunction(3, "Split global density", rho_loc, timer);
+
+    Timer t_pot;
+    mrcpp::CompFunction<3> V(false);
+    V.alloc(1);
+    if (part_norm > 0.0) {
+        // Adjust precision by part size and number of parts
+        double abs_prec = prec / (part_norm * std::sqrt(wrk_size));
+        mrcpp::apply(abs_prec, V.real(), P, rho_part);
+    } else {
+        V.real().setZero();
+    }
+    rho_loc.free();
+    print_utils::qmfunction(3, "Compute partial potential", V, t_pot);
+
+    return V;
+}
+
+/** @brief sum up local potential contributions from all MPI ranks
+ *
+ * @param prec: apply precision
+ * @param V_loc: local potential contribution
+ */
 void CoulombPotential::allreducePotential(double prec, mrcpp::CompFunction<3> &V_loc) {
     Timer t_com;
 
@@ -165,29 +412,7 @@ void CoulombPotential::allreducePotential(double prec, mrcpp::CompFunction<3> &V
     OrbitalVector &Phi = *this->orbitals;
 
     double abs_prec = prec / orbital::get_electron_number(Phi);
-
-    // Add up local contributions into the grand master
-    mrcpp::mpi::reduce_function(abs_prec, V_loc, mrcpp::mpi::comm_wrk);
-
-    if (not V_tot.hasReal()) V_tot.alloc(1);
-    if (V_tot.isShared()) {
-        int tag = 3141;
-        // MPI grand master distributes to shared masters
-        mrcpp::mpi::broadcast_function(V_loc, mrcpp::mpi::comm_sh_group);
-        if (mrcpp::mpi::share_master()) {
-            // MPI shared masters copies the function into final memory
-            mrcpp::copy_grid(V_tot.real(), V_loc.real());
-            mrcpp::copy_func(V_tot.real(), V_loc.real());
-        }
-        // MPI share masters distributes to their sharing ranks
-        mrcpp::mpi::share_function(V_tot, 0, tag, mrcpp::mpi::comm_share);
-    } else {
-        // MPI grand master distributes to all ranks
-        mrcpp::mpi::broadcast_function(V_loc, mrcpp::mpi::comm_wrk);
-        // All MPI ranks copies the function into final memory
-        mrcpp::copy_grid(V_tot.real(), V_loc.real());
-        mrcpp::copy_func(V_tot.real(), V_loc.real());
-    }
+    mpi_utils::allreduce_function(abs_prec, V_tot, V_loc, 3141);
     print_utils::qmfunction(3, "Allreduce potential", V_tot, t_com);
 }
 
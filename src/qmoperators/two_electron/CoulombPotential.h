@@ -45,36 +45,69 @@
  * on-the-fly in setup() ONLY if it is not already available. After setup() the
  * operator will be fixed until clear(), which deletes both the density and the
  * potential.
+ *
+ * In incremental mode (refresh interval > 0) the density and potential of the
+ * previous setup() are kept across clear(), and the new potential is obtained
+ * by applying the Poisson operator only to the density difference. A full
+ * rebuild is done every refresh interval to limit the accumulated error.
+ *
+ * In distributed mode (MPI, not numerically exact) the total density is
+ * computed first, and each rank applies the Poisson operator only to its own
+ * spatial part of it. The partial potentials are then summed over all ranks,
+ * so the Poisson work per rank decreases as ranks are added.
  */
 
 namespace mrchem {
 
+class DensityCache;
+
 class CoulombPotential : public QMPotential {
 public:
     explicit CoulombPotential(std::shared_ptr<mrcpp::PoissonOperator> P, std::shared_ptr<OrbitalVector> Phi = nullptr, bool mpi_share = false);
-    ~CoulombPotential() override = default;
+    ~CoulombPotential() override { clearPrevious(); }
 
     friend class CoulombOperator;
 
 protected:
     Density density; ///< Ground-state electron density
 
+    int refresh_interval{0};             ///< Setups between full rebuilds (0: never incremental)
+    int incremental_steps{0};            ///< Incremental setups since last full rebuild
+    double previous_prec{-1.0};          ///< Apply precision of the last full rebuild
+    Density previous_density;            ///< Density used for the stored potential
+    mrcpp::CompFunction<3> previous_pot; ///< Potential from the previous setup
+
     std::shared_ptr<OrbitalVector> orbitals;         ///< Unperturbed orbitals defining the ground-state electron density
     std::shared_ptr<mrcpp::PoissonOperator> poisson; ///< Operator used to compute the potential
+    std::shared_ptr<DensityCache> density_cache;     ///< Shared per-cycle densities (owned by FockBuilder)
+    bool borrowed_density{false};                    ///< Density is a shallow copy from the cache
+    bool distributed{false};                         ///< Split Poisson application over MPI ranks
 
     auto &getPoisson() { return this->poisson; }
     auto &getDensity() { return this->density; }
+    void setDensityCache(std::shared_ptr<DensityCache> cache) { this->density_cache = cache; }
+    void setRefreshInterval(int interval) { this->refresh_interval = interval; }
+    void setDistributed(bool distribute) { this->distributed = distribute; }
 
     bool hasDensity() const { return (this->density.getSquareNorm() <= 0.0) ? false : true; }
 
     void setup(double prec) override;
     void clear() override;
 
+    void savePotential(const std::string &file);
+    bool loadPotential(double prec, const std::string &file);
+
+    virtual void borrowDensity(double prec) {}
     virtual void setupGlobalDensity(double prec) {}
     virtual void setupLocalDensity(double prec) {}
 
     void setupGlobalPotential(double prec);
+    bool setupIncrementalPotential(double prec);
+    void storePotential();
+    void clearPrevious();
     mrcpp::CompFunction<3> setupLocalPotential(double prec);
+    mrcpp::CompFunction<3> setupDistributedPotential(double prec);
+    bool useDistributedPotential() const;
     void allreducePotential(double prec, mrcpp::CompFunction<3> &V_loc);
 };
 
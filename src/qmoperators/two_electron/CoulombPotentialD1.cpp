@@ -27,6 +27,7 @@
 #include "MRCPP/Timer"
 
 #include "CoulombPotentialD1.h"
+#include "qmfunctions/DensityCache.h"
 #include "qmfunctions/density_utils.h"
 #include "utils/print_utils.h"
 
@@ -38,6 +39,23 @@ using PoissonOperator_p = std::shared_ptr<mrcpp::PoissonOperator>;
 
 namespace mrchem {
 
+/** @brief fetch electron density from the shared density cache
+ *
+ * @param[in] prec: apply precision
+ *
+ * The density is shared with the other operators of the FockBuilder, and
+ * will not be freed by this operator. Does nothing if no cache is attached.
+ */
+void CoulombPotentialD1::borrowDensity(double prec) {
+    if (this->density_cache == nullptr) return;
+    if (this->orbitals == nullptr) MSG_ERROR("Orbitals not initialized");
+
+    Timer timer;
+    this->density = this->density_cache->get(prec, *this->orbitals, DensityType::Total);
+    this->borrowed_density = true;
+    print_utils::qmfunction(3, "Borrow global density", this->density, timer);
+}
+
 /** @brief compute electron density
  *
  * @param[in] prec: apply precision
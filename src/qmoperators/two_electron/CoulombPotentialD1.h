@@ -35,6 +35,7 @@ public:
             : CoulombPotential(P, Phi, mpi_share) {}
 
 private:
+    void borrowDensity(double prec) override;
     void setupLocalDensity(double prec) override;
     void setupGlobalDensity(double prec) override;
 };
@@ -25,6 +25,7 @@
 
 #include "FockBuilder.h"
 
+#include <MRCPP/Parallel>
 #include <MRCPP/Printer>
 #include <MRCPP/Timer>
 
@@ -35,6 +36,7 @@
 #include "analyticfunctions/NuclearFunction.h"
 #include "chemistry/chemistry_utils.h"
 #include "properties/SCFEnergy.h"
+#include "qmfunctions/DensityCache.h"
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/density_utils.h"
 #include "qmfunctions/orbital_utils.h"
@@ -58,10 +60,17 @@ namespace mrchem {
 
 /** @brief build the Fock operator once all contributions are in place
  *
+ * This will also attach a common DensityCache to all operators that need the
+ * ground-state electron density, such that it is computed only once per cycle.
  */
 void FockBuilder::build(double exx) {
     this->exact_exchange = exx;
 
+    if (this->density_cache == nullptr) this->density_cache = std::make_shared<DensityCache>();
+    if (this->coul != nullptr) this->coul->setDensityCache(this->density_cache);
+    if (this->xc != nullptr) this->xc->setDensityCache(this->density_cache);
+    if (this->Ro != nullptr) this->Ro->setDensityCache(this->density_cache);
+
     this->V = RankZeroOperator();
     if (this->nuc != nullptr) this->V += (*this->nuc);
     if (this->coul != nullptr) this->V += (*this->coul);
@@ -158,6 +167,53 @@ void FockBuilder::clear() {
         chiPot->free(mrchem::NUMBER::Total);
         chiInvPot->free(mrchem::NUMBER::Total);
     }
+    // orbitals are about to change, invalidate shared densities
+    if (this->density_cache != nullptr) this->density_cache->clear();
+}
+
+/** @brief write the expensive parts of a set up operator to disk
+ *
+ * @param file: file name prefix
+ * @param Phi: orbitals defining the operator
+ *
+ * This writes the total electron density ("<file>_rho") and the Coulomb
+ * potential ("<file>_coul"), such that a restarted calculation can set up the
+ * same operator with loadOperators() without the density construction and the
+ * Poisson application. Orbital dependent parts (exchange) and the potentials
+ * derived from the density (XC, reaction field) are rebuilt from these.
+ */
+void FockBuilder::saveOperators(const std::string &file, OrbitalVector &Phi) {
+    if (this->coul == nullptr or this->density_cache == nullptr) return;
+    Timer t_tot;
+    Density rho = this->density_cache->get(this->prec, Phi, DensityType::Total);
+    if (mrcpp::mpi::grand_master()) {
+        rho.saveDensity(file + "_rho");
+        this->coul->savePotential(file + "_coul");
+    }
+    mrcpp::print::time(1, "Writing Fock operator", t_tot);
+}
+
+/** @brief read the parts of an operator written by saveOperators()
+ *
+ * @param prec: precision the operator was set up with
+ * @param file: file name prefix
+ * @param Phi: orbitals defining the operator
+ *
+ * The density is handed to the DensityCache and the Coulomb potential is
+ * considered set up, so the next setup() with the same precision only builds
+ * the remaining operators. Must be called after build() and before setup().
+ * Operators stored with a looser precision than requested are not read, and
+ * are recomputed in setup() as usual.
+ */
+void FockBuilder::loadOperators(double prec, const std::string &file, OrbitalVector &Phi) {
+    if (this->coul == nullptr or this->density_cache == nullptr) return;
+    Timer t_tot;
+    if (this->coul->loadPotential(prec, file + "_coul")) {
+        Density rho(false);
+        rho.loadDensity(file + "_rho");
+        this->density_cache->put(prec, Phi, DensityType::Total, rho);
+    }
+    mrcpp::print::time(1, "Reading Fock operator", t_tot);
 }
 
 /** @brief rotate orbitals of two-electron operators
@@ -205,7 +261,13 @@ SCFEnergy FockBuilder::trace(OrbitalVector &Phi, const Nuclei &nucs) {
     // Reaction potential part
     if (this->Ro != nullptr) {
         Density rho_el(false);
-        density::compute(this->prec, rho_el, Phi, DensityType::Total);
+        if (this->density_cache != nullptr) {
+            // copy, since the cached density is shared with other operators
+            Density rho_cached = this->density_cache->get(this->prec, Phi, DensityType::Total);
+            mrcpp::deep_copy(rho_el, rho_cached);
+        } else {
+            density::compute(this->prec, rho_el, Phi, DensityType::Total);
+        }
         rho_el.rescale(-1.0);
         std::tie(Er_el, Er_nuc) = this->Ro->getSolver()->computeEnergies(rho_el);
 
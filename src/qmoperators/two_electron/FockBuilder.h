@@ -45,6 +45,7 @@
 namespace mrchem {
 
 class SCFEnergy;
+class DensityCache;
 class MomentumOperator;
 class KineticOperator;
 class ZoraKineticOperator;
@@ -71,12 +72,17 @@ public:
     std::shared_ptr<ElectricFieldOperator> &getExtOperator() { return this->ext; }
     std::shared_ptr<ReactionOperator> &getReactionOperator() { return this->Ro; }
     std::shared_ptr<AZoraPotential> &getAZoraChiPotential() { return this->chiPot; }
+    std::shared_ptr<DensityCache> &getDensityCache() { return this->density_cache; }
 
     void rotate(const ComplexMatrix &U);
 
     void build(double exx = 1.0);
     void setup(double prec);
     void clear();
+    double getPrecision() const { return this->prec; }
+
+    void saveOperators(const std::string &file, OrbitalVector &Phi);
+    void loadOperators(double prec, const std::string &file, OrbitalVector &Phi);
 
     void setLightSpeed(double c) { this->light_speed = c; }
     double getLightSpeed() const { return this->light_speed; }
@@ -105,7 +111,7 @@ private:
     double exact_exchange{1.0};
     RankZeroOperator zora_base;
 
-    double prec;
+    double prec{-1.0};
     Nuclei nucs;
 
     RankZeroOperator V;   ///< Total potential energy operator
@@ -120,6 +126,7 @@ private:
     std::shared_ptr<ElectricFieldOperator> ext{nullptr}; // Total external potential
     std::shared_ptr<ZoraOperator> chi{nullptr};
     std::shared_ptr<ZoraOperator> chi_inv{nullptr};
+    std::shared_ptr<DensityCache> density_cache{nullptr}; ///< Ground-state densities shared within one SCF cycle
 
     std::shared_ptr<QMPotential> collectZoraBasePotential();
     OrbitalVector buildHelmholtzArgumentZORA(OrbitalVector &Phi, OrbitalVector &Psi, DoubleVector eps, double prec);
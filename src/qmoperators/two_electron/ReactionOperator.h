@@ -65,6 +65,7 @@ public:
     GPESolver *getSolver() { return this->potential->getSolver(); }
     std::shared_ptr<ReactionPotential> getPotential() { return this->potential; }
     void updateMOResidual(double const err_t) { this->potential->updateMOResidual(err_t); }
+    void setDensityCache(std::shared_ptr<DensityCache> cache) { this->potential->setDensityCache(cache); }
 
 private:
     std::shared_ptr<ReactionPotential> potential{nullptr};
@@ -29,6 +29,8 @@
 #include "qmoperators/QMPotential.h"
 
 namespace mrchem {
+class DensityCache;
+
 /** @class ReactionPotential
  *  @brief class containing the solvent-substrate interaction reaction potential
  *  obtained by solving
@@ -53,11 +55,15 @@ public:
      * the dynamic convergence method. */
     void updateMOResidual(double const err_t) { this->solver->mo_residual = err_t; }
 
+    /** @brief Attach a shared per-cycle density cache, used to avoid recomputing the ground-state density. */
+    void setDensityCache(std::shared_ptr<DensityCache> cache) { this->density_cache = cache; }
+
     friend class ReactionOperator;
 
 protected:
     std::unique_ptr<GPESolver> solver;       //!< A GPESolver instance used to compute the ReactionPotential.
     std::shared_ptr<OrbitalVector> orbitals; ///< Unperturbed orbitals defining the ground-state electron density for the SCRF procedure.
+    std::shared_ptr<DensityCache> density_cache{nullptr}; ///< Shared per-cycle densities (owned by FockBuilder)
 
     void setup(double prec) override;
     void clear() override;
@@ -28,6 +28,7 @@
 #include <MRCPP/Printer>
 #include <MRCPP/Timer>
 
+#include "qmfunctions/DensityCache.h"
 #include "qmfunctions/density_utils.h"
 #include "utils/print_utils.h"
 
@@ -42,7 +43,13 @@ mrcpp::CompFunction<3> &ReactionPotentialD1::computePotential(double prec) const
     // construct electronic density from the orbitals
     OrbitalVector &Phi = *this->orbitals;
     Density rho_el(false);
-    density::compute(this->apply_prec, rho_el, Phi, DensityType::Total);
+    if (this->density_cache != nullptr) {
+        // copy, since the cached density is shared with other operators
+        Density rho_cached = this->density_cache->get(this->apply_prec, Phi, DensityType::Total);
+        mrcpp::deep_copy(rho_el, rho_cached);
+    } else {
+        density::compute(this->apply_prec, rho_el, Phi, DensityType::Total);
+    }
     // change sign, because it's the electronic density
     rho_el.rescale(-1.0);
 
@@ -71,6 +71,7 @@ public:
     void clearSpin() { this->potential->setReal(nullptr); }
 
     std::shared_ptr<XCPotential> getPotential() { return potential; }
+    void setDensityCache(std::shared_ptr<DensityCache> cache) { this->potential->setDensityCache(cache); }
 
 private:
     std::shared_ptr<XCPotential> potential{nullptr};
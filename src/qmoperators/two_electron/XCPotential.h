@@ -54,6 +54,8 @@
 
 namespace mrchem {
 
+class DensityCache;
+
 class XCPotential : public QMPotential {
 public:
     explicit XCPotential(std::unique_ptr<mrdft::MRDFT> &F, std::shared_ptr<OrbitalVector> Phi = nullptr, bool mpi_shared = false)
@@ -77,10 +79,12 @@ protected:
     std::shared_ptr<mrcpp::FunctionTree<3>> v_tot{nullptr}; ///< Total XC potential
     std::shared_ptr<OrbitalVector> orbitals;                ///< External set of orbitals used to build the density
     std::unique_ptr<mrdft::MRDFT> mrdft;                    ///< External XC functional to be used
+    std::shared_ptr<DensityCache> density_cache{nullptr};   ///< Shared per-cycle densities (owned by FockBuilder)
 
     double getEnergy() const { return this->energy; }
     Density &getDensity(DensityType spin, int pert_idx);
     mrcpp::FunctionTree<3> &getPotential(int spin);
+    void setDensityCache(std::shared_ptr<DensityCache> cache) { this->density_cache = cache; }
 
     void setup(double prec) override;
     void clear() override;
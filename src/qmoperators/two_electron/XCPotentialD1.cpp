@@ -29,6 +29,7 @@
 #include "XCPotential.h"
 #include "XCPotentialD1.h"
 #include "qmfunctions/Density.h"
+#include "qmfunctions/DensityCache.h"
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/density_utils.h"
 #include "qmfunctions/orbital_utils.h"
@@ -46,6 +47,38 @@ XCPotentialD1::XCPotentialD1(std::unique_ptr<mrdft::MRDFT> &F, std::shared_ptr<O
     densities.push_back(Density(false)); // rho_0 beta
 }
 
+/** @brief Clear operator, releasing any densities borrowed from the cache */
+void XCPotentialD1::clear() {
+    if (this->borrowed_densities) {
+        // trees are owned by the cache
+        for (auto &rho : this->densities) rho = Density(false);
+        this->borrowed_densities = false;
+    }
+    XCPotential::clear();
+}
+
+/** @brief Compute or borrow a single unperturbed density
+ *
+ * @param[in] prec Density precision
+ * @param[out] rho Output density, untouched if already computed
+ * @param[in] spin Type of density
+ * @param[in] grid Grid of the XC functional
+ *
+ * If a DensityCache is attached the density is shared with the other operators,
+ * and will be refined onto the XC grid in MRDFT::evaluate().
+ */
+void XCPotentialD1::setupDensity(double prec, Density &rho, DensityType spin, mrcpp::FunctionTree<3> &grid) {
+    if (rho.Ncomp() != 0) return;
+    if (this->density_cache != nullptr and this->orbitals != nullptr) {
+        rho = this->density_cache->get(prec, *orbitals, spin);
+        this->borrowed_densities = true;
+    } else {
+        rho.alloc(1);
+        mrcpp::copy_grid(rho.real(), grid);
+        density::compute(prec, rho, *orbitals, spin);
+    }
+}
+
 mrcpp::FunctionTreeVector<3> XCPotentialD1::setupDensities(double prec, mrcpp::FunctionTree<3> &grid) {
     mrcpp::FunctionTreeVector<3> dens_vec;
     if (not this->mrdft->functional().isSpin()) {
@@ -53,11 +86,7 @@ mrcpp::FunctionTreeVector<3> XCPotentialD1::setupDensities(double prec, mrcpp::F
         { // Unperturbed total density
             Timer timer;
             Density &rho = getDensity(DensityType::Total, 0);
-            if (rho.Ncomp() == 0) {
-                rho.alloc(1);
-                mrcpp::copy_grid(rho.real(), grid);
-                density::compute(prec, rho, *orbitals, DensityType::Total);
-            }
+            setupDensity(prec, rho, DensityType::Total, grid);
             print_utils::qmfunction(3, "Compute rho", rho, timer);
             dens_vec.push_back(std::make_tuple(1.0, &rho.real()));
         }
@@ -65,22 +94,14 @@ mrcpp::FunctionTreeVector<3> XCPotentialD1::setupDensities(double prec, mrcpp::F
         { // Unperturbed alpha density
             Timer timer;
             Density &rho = getDensity(DensityType::Alpha, 0);
-            if (rho.Ncomp() == 0) {
-                rho.alloc(1);
-                mrcpp::copy_grid(rho.real(), grid);
-                density::compute(prec, rho, *orbitals, DensityType::Alpha);
-            }
+            setupDensity(prec, rho, DensityType::Alpha, grid);
             print_utils::qmfunction(3, "Compute rho (alpha)", rho, timer);
             dens_vec.push_back(std::make_tuple(1.0, &rho.real()));
         }
         { // Unperturbed beta density
             Timer timer;
             Density &rho = getDensity(DensityType::Beta, 0);
-            if (rho.Ncomp() == 0) {
-                rho.alloc(1);
-                mrcpp::copy_grid(rho.real(), grid);
-                density::compute(prec, rho, *orbitals, DensityType::Beta);
-            }
+            setupDensity(prec, rho, DensityType::Beta, grid);
             print_utils::qmfunction(3, "Compute rho (beta)", rho, timer);
             dens_vec.push_back(std::make_tuple(1.0, &rho.real()));
         }
@@ -42,7 +42,8 @@
  * MUST be explicitly computed prior to setup(). The density will be computed
  * on-the-fly in setup() ONLY if it is not already available. After setup() the
  * operator will be fixed until clear(), which deletes both the density and the
- * potential.
+ * potential. If a DensityCache is attached, the densities are instead borrowed
+ * from the cache, and released (not deleted) in clear().
  *
  * LDA and GGA functionals are supported as well as two different ways to compute
  * the XC potentials: either with explicit derivatives or gamma-type derivatives.
@@ -55,6 +56,10 @@ public:
     explicit XCPotentialD1(std::unique_ptr<mrdft::MRDFT> &F, std::shared_ptr<OrbitalVector> Phi = nullptr, bool mpi_shared = false);
 
 private:
+    bool borrowed_densities{false}; ///< Densities are shallow copies from the cache
+
+    void clear() override;
+    void setupDensity(double prec, Density &rho, DensityType spin, mrcpp::FunctionTree<3> &grid);
     mrcpp::FunctionTreeVector<3> setupDensities(double prec, mrcpp::FunctionTree<3> &grid) override;
 };
 
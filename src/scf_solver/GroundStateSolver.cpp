@@ -338,7 +338,7 @@ json GroundStateSolver::optimize(Molecule &mol, FockBuilder &F) {
 
         // Rotate orbitals
         if (needLocalization(nIter, converged)) {
-            ComplexMatrix U_mat = orbital::localize(orb_prec, Phi_n, F_mat);
+            ComplexMatrix U_mat = orbital::localize(orb_prec, Phi_n, F_mat, this->localizeMethod == "jacobi");
             F.rotate(U_mat);
             kain.clear();
         } else if (needDiagonalization(nIter, converged)) {
@@ -367,7 +367,8 @@ json GroundStateSolver::optimize(Molecule &mol, FockBuilder &F) {
         if (converged) break;
     }
 
-    F.clear();
+    // A kept operator is consistent with the final (rotated) orbitals
+    if (not this->keepOperator) F.clear();
     mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
 
     printConvergence(converged, "Total energy");
@@ -57,14 +57,18 @@ public:
 
     void setRotation(int iter) { this->rotation = iter; }
     void setLocalize(bool loc) { this->localize = loc; }
+    void setLocalizeMethod(const std::string &method) { this->localizeMethod = method; }
     void setCheckpointFile(const std::string &file) { this->chkFile = file; }
+    void setKeepOperator(bool keep) { this->keepOperator = keep; }
 
     nlohmann::json optimize(Molecule &mol, FockBuilder &F);
 
 protected:
-    int rotation{0};      ///< Number of iterations between localization/diagonalization
-    bool localize{false}; ///< Use localized or canonical orbitals
-    std::string chkFile;  ///< Name of checkpoint file
+    int rotation{0};                      ///< Number of iterations between localization/diagonalization
+    bool localize{false};                 ///< Use localized or canonical orbitals
+    std::string localizeMethod{"newton"}; ///< Localization algorithm (newton or jacobi)
+    bool keepOperator{false};             ///< Leave the final Fock operator set up for later use
+    std::string chkFile;                  ///< Name of checkpoint file
     std::vector<SCFEnergy> energy;
 
     void reset() override;
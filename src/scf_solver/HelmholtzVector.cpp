@@ -46,11 +46,14 @@ extern mrcpp::MultiResolutionAnalysis<3> *MRA; // Global MRA
  * This will set the build precision of the Helmholtz operators and the vector
  * of lambda parameters that will be used in the subsequent application. No
  * operators are constructed at this point, they are produced on-the-fly in
- * the application.
+ * the application. With cache = true each operator is kept after its first
+ * construction and reused in later applications of the same vector.
  */
-HelmholtzVector::HelmholtzVector(double pr, const DoubleVector &l)
-        : prec(pr) {
+HelmholtzVector::HelmholtzVector(double pr, const DoubleVector &l, bool cache)
+        : prec(pr)
+        , cacheOperators(cache) {
     this->lambda = l;
+    this->operators.resize(this->lambda.size());
     for (int i = 0; i < this->lambda.size(); i++) {
         if (this->lambda(i) > 0.0) this->lambda(i) = -0.5;
     }
@@ -139,9 +142,8 @@ OrbitalVector HelmholtzVector::apply(RankZeroOperator &V, OrbitalVector &Phi, Or
  * Computes output as: out_i = -2H_i[phi_i]
  */
 Orbital HelmholtzVector::apply(int i, const Orbital &phi) const {
-    ComplexDouble mu_i = std::sqrt(-2.0 * this->lambda(i));
-    if (std::abs(mu_i.imag()) > mrcpp::MachineZero) MSG_ABORT("Mu cannot be complex");
-    mrcpp::HelmholtzOperator H(*MRA, mu_i.real(), this->prec);
+    auto H_p = getOperator(i);
+    auto &H = *H_p;
 
     Orbital out = phi.paramCopy(true);
     ComplexDouble metric[4][4];
@@ -158,4 +160,18 @@ Orbital HelmholtzVector::apply(int i, const Orbital &phi) const {
 
     return out;
 }
+
+/** @brief Return the Helmholtz operator for the i-th lambda parameter
+ *
+ * The operator is constructed on the fly, and stored for later use if
+ * caching is enabled.
+ */
+std::shared_ptr<mrcpp::HelmholtzOperator> HelmholtzVector::getOperator(int i) const {
+    if (this->operators[i] != nullptr) return this->operators[i];
+    ComplexDouble mu_i = std::sqrt(-2.0 * this->lambda(i));
+    if (std::abs(mu_i.imag()) > mrcpp::MachineZero) MSG_ABORT("Mu cannot be complex");
+    auto H = std::make_shared<mrcpp::HelmholtzOperator>(*MRA, mu_i.real(), this->prec);
+    if (this->cacheOperators) this->operators[i] = H;
+    return H;
+}
 } // namespace mrchem
@@ -25,23 +25,33 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "mrchem.h"
 #include "qmfunctions/qmfunction_fwd.h"
 #include "tensor/tensor_fwd.h"
 
+namespace mrcpp {
+class HelmholtzOperator;
+} // namespace mrcpp
+
 /** @class HelmholtzVector
  *
  * @brief Container of HelmholtzOperators for a corresponding OrbtialVector
  *
  * This class assigns one HelmholtzOperator to each orbital in an OrbitalVector.
  * The operators are produced on the fly based on a vector of lambda parameters.
+ * Optionally the operators are kept after their first application, so that
+ * repeated applications with the same lambda parameters (several perturbation
+ * components, or several SCF cycles with fixed parameters) reuse the kernels.
  */
 
 namespace mrchem {
 
 class HelmholtzVector final {
 public:
-    HelmholtzVector(double pr, const DoubleVector &l);
+    HelmholtzVector(double pr, const DoubleVector &l, bool cache = false);
 
     DoubleMatrix getLambdaMatrix() const { return this->lambda.asDiagonal(); }
 
@@ -51,6 +61,10 @@ public:
 private:
     double prec;         ///< Precision for construction and application of Helmholtz operators
     DoubleVector lambda; ///< Helmholtz parameter, mu_i = sqrt(-2.0*lambda_i)
+    bool cacheOperators; ///< Keep operators between applications
+    mutable std::vector<std::shared_ptr<mrcpp::HelmholtzOperator>> operators;
+
+    std::shared_ptr<mrcpp::HelmholtzOperator> getOperator(int i) const;
 
     Orbital apply(int i, const Orbital &phi) const;
 };
@@ -23,6 +23,8 @@
  * <https://mrchem.readthedocs.io/>
  */
 
+#include <algorithm>
+
 #include <MRCPP/Printer>
 #include <MRCPP/Timer>
 
@@ -34,6 +36,7 @@
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/orbital_utils.h"
 #include "qmoperators/two_electron/FockBuilder.h"
+#include "tensor/RankZeroOperator.h"
 #include "utils/print_utils.h"
 
 using mrcpp::Printer;
@@ -46,52 +49,72 @@ namespace mrchem {
  *
  * Optimize orbitals until convergence thresholds are met. This algorithm iterates
  * the Sternheimer response equations in integral form. Common implementation for
- * static and dynamic response. Main points of the algorithm:
+ * static and dynamic response. All perturbation components in the block are
+ * iterated together, sharing the unperturbed potential and the Helmholtz
+ * operators, which only depend on the unperturbed orbital energies and the
+ * frequency. Main points of the algorithm:
  *
  * Pre SCF: setup Helmholtz operators with unperturbed energies
  *
- *  1) Setup perturbed Fock operator
- *  2) For X and Y orbitals do:
- *     a) Apply Helmholtz operator on all orbitals
- *     b) Project out occupied space (1 - rho_0)
- *     c) Compute updates and errors
- *     d) Compute KAIN updates
- *  4) Compute property
- *  5) Check for convergence
+ *  1) For each unconverged component do:
+ *     a) Setup perturbed Fock operator
+ *     b) For X and Y orbitals do:
+ *        i)   Apply Helmholtz operator on all orbitals
+ *        ii)  Project out occupied space (1 - rho_0)
+ *        iii) Compute updates and errors
+ *        iv)  Compute KAIN updates
+ *     c) Compute property
+ *     d) Check for convergence of the component
+ *  2) Check for convergence of the block
  *
+ * Converged components are frozen and skipped in the remaining cycles.
  */
-json LinearResponseSolver::optimize(double omega, Molecule &mol, FockBuilder &F_0, FockBuilder &F_1) {
-    printParameters(omega, F_1.perturbation().name());
+json LinearResponseSolver::optimize(double omega, Molecule &mol, FockBuilder &F_0, std::vector<ResponseComponent> &block) {
+    int nComps = block.size();
+    std::stringstream o_oper;
+    for (int k = 0; k < nComps; k++) o_oper << ((k > 0) ? ", " : "") << block[k].F_1->perturbation().name();
+    printParameters(omega, o_oper.str());
     Timer t_tot;
     json json_out;
 
-    // Setup KAIN accelerators
-    KAIN kain_x(this->history);
-    KAIN kain_y(this->history);
     OrbitalVector &Phi_0 = mol.getOrbitals();
-    OrbitalVector &X_n = mol.getOrbitalsX();
-    OrbitalVector &Y_n = mol.getOrbitalsY();
     ComplexMatrix &F_mat_0 = mol.getFockMatrix();
     ComplexMatrix F_mat_x = F_mat_0 + omega * ComplexMatrix::Identity(Phi_0.size(), Phi_0.size());
     ComplexMatrix F_mat_y = F_mat_0 - omega * ComplexMatrix::Identity(Phi_0.size(), Phi_0.size());
 
+    // Setup KAIN accelerators and perturbation operators for each component
+    std::vector<std::unique_ptr<KAIN>> kain_x;
+    std::vector<std::unique_ptr<KAIN>> kain_y;
+    std::vector<RankZeroOperator> V_1;
+    for (auto &comp : block) {
+        kain_x.push_back(std::make_unique<KAIN>(this->history));
+        kain_y.push_back(std::make_unique<KAIN>(this->history));
+        RankZeroOperator V_1_k = comp.F_1->perturbation();
+        if (comp.F_1->potential().isImag() == comp.F_1->perturbation().isImag()) V_1_k += comp.F_1->potential();
+        V_1.push_back(V_1_k);
+    }
     RankZeroOperator V_0 = F_0.potential();
-    RankZeroOperator V_1 = F_1.perturbation();
-    if( F_1.potential().isImag() == F_1.perturbation().isImag()) V_1 += F_1.potential();
+
     double err_o = 1.0;
     double err_t = 1.0;
-    DoubleVector errors_x = DoubleVector::Zero(Phi_0.size());
-    DoubleVector errors_y = DoubleVector::Zero(Phi_0.size());
+    DoubleMatrix errors_x = DoubleMatrix::Zero(Phi_0.size(), nComps);
+    DoubleMatrix errors_y = DoubleMatrix::Zero(Phi_0.size(), nComps);
+    DoubleVector props = DoubleVector::Zero(nComps);
+    std::vector<bool> done(nComps, false);
+
+    // Each component keeps its own record of cycles and timings
+    std::vector<json> comp_out(nComps);
+    for (auto &json_comp : comp_out) json_comp["cycles"] = json::array();
+    std::vector<double> comp_time(nComps, 0.0);
 
     this->error.push_back(err_t);
     this->property.push_back(0.0);
 
-    // Setup Helmholtz operators (fixed, based on unperturbed system)
+    // Setup Helmholtz operators (fixed, based on unperturbed system), the
+    // kernels are built once and shared by all components and cycles
     double helm_prec = getHelmholtzPrec();
-    HelmholtzVector H_x(helm_prec, F_mat_x.real().diagonal());
-    HelmholtzVector H_y(helm_prec, F_mat_y.real().diagonal());
-    ComplexMatrix L_mat_x = H_x.getLambdaMatrix();
-    ComplexMatrix L_mat_y = H_y.getLambdaMatrix();
+    HelmholtzVector H_x(helm_prec, F_mat_x.real().diagonal(), true);
+    HelmholtzVector H_y(helm_prec, F_mat_y.real().diagonal(), true);
 
     auto plevel = Printer::getPrintLevel();
     if (plevel < 1) {
@@ -101,9 +124,7 @@ json LinearResponseSolver::optimize(double omega, Molecule &mol, FockBuilder &F_
 
     int nIter = 0;
     bool converged = false;
-    json_out["cycles"] = {};
     while (nIter++ < this->maxIter or this->maxIter < 0) {
-        json json_cycle;
         std::stringstream o_header;
         o_header << "SCF cycle " << nIter;
         mrcpp::print::header(1, o_header.str(), 0, '#');
@@ -113,161 +134,169 @@ json LinearResponseSolver::optimize(double omega, Molecule &mol, FockBuilder &F_
         Timer t_scf, t_lap;
         double orb_prec = adjustPrecision(err_o);
 
-        // Setup perturbed Fock operator (including V_1)
-        F_1.setup(orb_prec);
-
-        if (dynamic and plevel == 1) mrcpp::print::separator(1, '-');
+        for (int k = 0; k < nComps; k++) {
+            if (done[k]) continue;
+            Timer t_comp;
+            auto &comp = block[k];
+            OrbitalVector &X_n = *comp.X;
+            OrbitalVector &Y_n = *comp.Y;
+            print_utils::text(1, "Perturbation", comp.F_1->perturbation().name());
 
-        { // Iterate X orbitals
-            // Compute argument: psi_i = sum_j [L-F]_ij*x_j + (1 - rho_0)V_1(phi_i)
-            Timer t_arg;
-            mrcpp::print::header(2, "Computing Helmholtz argument");
-            t_lap.start();
-            OrbitalVector Psi_1 = V_1(Phi_0);
-            mrcpp::print::time(2, "Applying V_1", t_lap);
+            // Setup perturbed Fock operator (including V_1)
+            comp.F_1->setup(orb_prec);
 
-            t_lap.start();
-            mrcpp::orthogonalize(this->orth_prec, Psi_1, Phi_0);
-            mrcpp::print::time(2, "Projecting (1 - rho_0)", t_lap);
+            if (dynamic and plevel == 1) mrcpp::print::separator(1, '-');
 
-            t_lap.start();
-            OrbitalVector Psi_2 = orbital::rotate(X_n, L_mat_x - F_mat_x);
-            mrcpp::print::time(2, "Rotating orbitals", t_lap);
+            // Iterate X orbitals: psi_i = sum_j [L-F]_ij*x_j + (1 - rho_0)V_1(phi_i)
+            errors_x.col(k) = iterateOrbitals(orb_prec, V_0, V_1[k], false, H_x, F_mat_x, Phi_0, X_n, *kain_x[k]);
+            if (this->checkpoint) orbital::save_orbitals(X_n, comp.chkFileX);
 
-            OrbitalVector Psi = orbital::add(1.0, Psi_1, 1.0, Psi_2, -1.0);
-            Psi_1.clear();
-            Psi_2.clear();
-            mrcpp::print::footer(2, t_arg, 2);
-            if (plevel == 1) mrcpp::print::time(1, "Computing Helmholtz argument", t_arg);
+            if (dynamic and plevel == 1) mrcpp::print::separator(1, '-');
 
-            // Apply Helmholtz operators
-            OrbitalVector X_np1 = H_x.apply(V_0, X_n, Psi);
-            Psi.clear();
+            // Iterate Y orbitals: psi_i = sum_j [L-F]_ij*y_j + (1 - rho_0)V_1.dagger(phi_i)
+            if (dynamic) {
+                errors_y.col(k) = iterateOrbitals(orb_prec, V_0, V_1[k], true, H_y, F_mat_y, Phi_0, Y_n, *kain_y[k]);
+                if (this->checkpoint) orbital::save_orbitals(Y_n, comp.chkFileY);
+            }
 
-            // Projecting (1 - rho_0)X
-            mrcpp::print::header(2, "Projecting occupied space");
+            // Compute property
+            mrcpp::print::header(2, "Computing symmetric property");
             t_lap.start();
-            orbital::orthogonalize(this->orth_prec, X_np1, Phi_0);
-            mrcpp::print::time(2, "Projecting (1 - rho_0)", t_lap);
+            double prop_k = comp.F_1->perturbation().trace(Phi_0, X_n, Y_n).real();
             mrcpp::print::footer(2, t_lap, 2);
-            if (plevel == 1) mrcpp::print::time(1, "Projecting occupied space", t_lap);
-
-            // Compute update and errors
-            OrbitalVector dX_n = orbital::add(1.0, X_np1, -1.0, X_n);
-            errors_x = orbital::get_norms(dX_n);
-            X_np1.clear();
-
-            // Compute KAIN update:
-            kain_x.accelerate(orb_prec, X_n, dX_n);
-
-            // Prepare for next iteration
-            X_n = orbital::add(1.0, dX_n, 1.0, X_n); // The result inherits parameters from dX_n
-
-            // Save checkpoint file
-            if (this->checkpoint) orbital::save_orbitals(X_n, this->chkFileX);
+            if (plevel == 1) mrcpp::print::time(1, "Computing symmetric property", t_lap);
+
+            // Clear perturbed Fock operator
+            comp.F_1->clear();
+
+            // Check convergence of this component
+            double err_o_k = std::max(errors_x.col(k).maxCoeff(), errors_y.col(k).maxCoeff());
+            double err_p_k = std::abs(prop_k - props(k));
+            props(k) = prop_k;
+            done[k] = checkConvergence(err_o_k, err_p_k);
+
+            printOrbitals(orbital::get_norms(X_n), errors_x.col(k), X_n, 1);
+            if (dynamic) printOrbitals(orbital::get_norms(Y_n), errors_y.col(k), Y_n, 1, false);
+            mrcpp::print::separator(1, '-');
+
+            t_comp.stop();
+            json json_cycle;
+            json_cycle["symmetric_property"] = prop_k;
+            json_cycle["property_update"] = err_p_k;
+            json_cycle["mo_residual"] = std::sqrt(errors_x.col(k).squaredNorm() + errors_y.col(k).squaredNorm());
+            json_cycle["wall_time"] = t_comp.elapsed();
+            comp_out[k]["cycles"].push_back(json_cycle);
+            comp_time[k] += t_comp.elapsed();
         }
 
-        if (dynamic and plevel == 1) mrcpp::print::separator(1, '-');
-
-        if (dynamic) { // Iterate Y orbitals
-            // Compute argument: psi_i = sum_j [L-F]_ij*y_j + (1 - rho_0)V_1.dagger(phi_i)
-            Timer t_arg;
-            mrcpp::print::header(2, "Computing Helmholtz argument");
-            t_lap.start();
-            OrbitalVector Psi_1 = V_1.dagger(Phi_0);
-            mrcpp::print::time(2, "Applying V_1.dagger()", t_lap);
-
-            t_lap.start();
-            orbital::orthogonalize(this->orth_prec, Psi_1, Phi_0);
-            mrcpp::print::time(2, "Projecting (1 - rho_0)", t_lap);
-
-            t_lap.start();
-            OrbitalVector Psi_2 = orbital::rotate(Y_n, L_mat_y - F_mat_y);
-            mrcpp::print::time(2, "Rotating orbitals", t_lap);
-
-            OrbitalVector Psi = orbital::add(1.0, Psi_1, 1.0, Psi_2, -1.0);
-            Psi_1.clear();
-            Psi_2.clear();
-            mrcpp::print::footer(2, t_arg, 2);
-            if (plevel == 1) mrcpp::print::time(1, "Computing Helmholtz argument", t_arg);
-
-            // Apply Helmholtz operators
-            OrbitalVector Y_np1 = H_y.apply(V_0, Y_n, Psi);
-            Psi.clear();
-
-            // Projecting (1 - rho_0)X
-            mrcpp::print::header(2, "Projecting occupied space");
-            t_lap.start();
-            orbital::orthogonalize(this->orth_prec, Y_np1, Phi_0);
-            mrcpp::print::time(2, "Projecting (1 - rho_0)", t_lap);
-            mrcpp::print::footer(2, t_lap, 2);
-            if (plevel == 1) mrcpp::print::time(1, "Projecting occupied space", t_lap);
-
-            // Compute update and errors
-            OrbitalVector dY_n = orbital::add(1.0, Y_np1, -1.0, Y_n);
-            errors_y = orbital::get_norms(dY_n);
-            Y_np1.clear();
-
-            // Compute KAIN update:
-            kain_y.accelerate(orb_prec, Y_n, dY_n);
-
-            // Prepare for next iteration
-            Y_n = orbital::add(1.0, dY_n, 1.0, Y_n);
-
-            // Save checkpoint file
-            if (this->checkpoint) orbital::save_orbitals(Y_n, this->chkFileY);
-        }
-
-        // Compute property
-        mrcpp::print::header(2, "Computing symmetric property");
-        t_lap.start();
-        double prop = F_1.perturbation().trace(Phi_0, X_n, Y_n).real();
-        mrcpp::print::footer(2, t_lap, 2);
-        if (plevel == 1) mrcpp::print::time(1, "Computing symmetric property", t_lap);
-
-        // Clear perturbed Fock operator
-        F_1.clear();
-
-        // Compute errors
+        // Compute errors, frozen components keep their last errors
         err_o = std::max(errors_x.maxCoeff(), errors_y.maxCoeff());
-        err_t = std::sqrt(errors_x.dot(errors_x) + errors_y.dot(errors_y));
-        json_cycle["mo_residual"] = err_t;
+        err_t = std::sqrt(errors_x.squaredNorm() + errors_y.squaredNorm());
 
-        // Collect convergence data
+        // Collect convergence data, the property is the trace over the block
         this->error.push_back(err_t);
-        this->property.push_back(prop);
-        double err_p = getUpdate(this->property, nIter + 1, true);
-        converged = checkConvergence(err_o, err_p);
-
-        json_cycle["symmetric_property"] = prop;
-        json_cycle["property_update"] = err_p;
+        this->property.push_back(props.sum());
+        converged = std::all_of(done.begin(), done.end(), [](bool d) { return d; });
 
         // Finalize SCF cycle
         if (plevel < 1) printConvergenceRow(nIter);
-        printOrbitals(orbital::get_norms(X_n), errors_x, X_n, 1);
-        if (dynamic) printOrbitals(orbital::get_norms(Y_n), errors_y, Y_n, 1, false);
-        mrcpp::print::separator(1, '-');
         printResidual(err_t, converged);
         mrcpp::print::separator(2, '=', 2);
         printProperty();
         printMemory();
         t_scf.stop();
-        json_cycle["wall_time"] = t_scf.elapsed();
         mrcpp::print::footer(1, t_scf, 2, '#');
         mrcpp::print::separator(2, ' ', 2);
 
-        json_out["cycles"].push_back(json_cycle);
         if (converged) break;
     }
 
     printConvergence(converged, "Symmetric property");
     reset();
 
+    json_out["components"] = json::array();
+    for (int k = 0; k < nComps; k++) {
+        comp_out[k]["wall_time"] = comp_time[k];
+        comp_out[k]["converged"] = static_cast<bool>(done[k]);
+        json_out["components"].push_back(comp_out[k]);
+    }
     json_out["wall_time"] = t_tot.elapsed();
     json_out["converged"] = converged;
     return json_out;
 }
 
+/** @brief Perform one update of a set of perturbed orbitals
+ *
+ * @param prec: current orbital precision
+ * @param V_0: unperturbed potential
+ * @param V_1: perturbation operator (including the response potential)
+ * @param adjoint: use the adjoint of V_1 (Y orbitals)
+ * @param H: Helmholtz operators for this set of orbitals
+ * @param F_mat: shifted unperturbed Fock matrix
+ * @param Phi_0: unperturbed orbitals
+ * @param X_n: perturbed orbitals, updated in place
+ * @param kain: KAIN accelerator for this set of orbitals
+ *
+ * Returns the norms of the orbital updates.
+ */
+DoubleVector LinearResponseSolver::iterateOrbitals(double prec,
+                                                   RankZeroOperator &V_0,
+                                                   RankZeroOperator &V_1,
+                                                   bool adjoint,
+                                                   const HelmholtzVector &H,
+                                                   const ComplexMatrix &F_mat,
+                                                   OrbitalVector &Phi_0,
+                                                   OrbitalVector &X_n,
+                                                   KAIN &kain) {
+    auto plevel = Printer::getPrintLevel();
+    Timer t_arg, t_lap;
+
+    // Compute argument: psi_i = sum_j [L-F]_ij*x_j + (1 - rho_0)V_1(phi_i)
+    mrcpp::print::header(2, "Computing Helmholtz argument");
+    t_lap.start();
+    OrbitalVector Psi_1 = (adjoint) ? V_1.dagger(Phi_0) : V_1(Phi_0);
+    mrcpp::print::time(2, (adjoint) ? "Applying V_1.dagger()" : "Applying V_1", t_lap);
+
+    t_lap.start();
+    orbital::orthogonalize(this->orth_prec, Psi_1, Phi_0);
+    mrcpp::print::time(2, "Projecting (1 - rho_0)", t_lap);
+
+    t_lap.start();
+    ComplexMatrix L_mat = H.getLambdaMatrix();
+    OrbitalVector Psi_2 = orbital::rotate(X_n, L_mat - F_mat);
+    mrcpp::print::time(2, "Rotating orbitals", t_lap);
+
+    OrbitalVector Psi = orbital::add(1.0, Psi_1, 1.0, Psi_2, -1.0);
+    Psi_1.clear();
+    Psi_2.clear();
+    mrcpp::print::footer(2, t_arg, 2);
+    if (plevel == 1) mrcpp::print::time(1, "Computing Helmholtz argument", t_arg);
+
+    // Apply Helmholtz operators
+    OrbitalVector X_np1 = H.apply(V_0, X_n, Psi);
+    Psi.clear();
+
+    // Projecting (1 - rho_0)X
+    mrcpp::print::header(2, "Projecting occupied space");
+    t_lap.start();
+    orbital::orthogonalize(this->orth_prec, X_np1, Phi_0);
+    mrcpp::print::time(2, "Projecting (1 - rho_0)", t_lap);
+    mrcpp::print::footer(2, t_lap, 2);
+    if (plevel == 1) mrcpp::print::time(1, "Projecting occupied space", t_lap);
+
+    // Compute update and errors
+    OrbitalVector dX_n = orbital::add(1.0, X_np1, -1.0, X_n);
+    DoubleVector errors = orbital::get_norms(dX_n);
+    X_np1.clear();
+
+    // Compute KAIN update:
+    kain.accelerate(prec, X_n, dX_n);
+
+    // Prepare for next iteration
+    X_n = orbital::add(1.0, dX_n, 1.0, X_n); // The result inherits parameters from dX_n
+    return errors;
+}
+
 /** @brief Pretty printing of the computed property with update */
 void LinearResponseSolver::printProperty() const {
     double prop_0(0.0), prop_1(0.0);
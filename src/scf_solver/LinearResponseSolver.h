@@ -25,9 +25,12 @@
 
 #pragma once
 
+#include <memory>
+
 #include <nlohmann/json.hpp>
 
 #include "SCFSolver.h"
+#include "tensor/tensor_fwd.h"
 
 /** @class LinearResponseSolver
  *
@@ -37,6 +40,17 @@ namespace mrchem {
 
 class Molecule;
 class FockBuilder;
+class HelmholtzVector;
+class KAIN;
+
+/** @brief Perturbed Fock operator, orbitals and checkpoint files of one perturbation component */
+struct ResponseComponent {
+    FockBuilder *F_1{nullptr};
+    std::shared_ptr<OrbitalVector> X{nullptr};
+    std::shared_ptr<OrbitalVector> Y{nullptr}; ///< Same vector as X for static response
+    std::string chkFileX;                      ///< Name of checkpoint file
+    std::string chkFileY;                      ///< Name of checkpoint file
+};
 
 class LinearResponseSolver final : public SCFSolver {
 public:
@@ -44,18 +58,22 @@ public:
             : dynamic(dyn) {}
     ~LinearResponseSolver() override = default;
 
-    nlohmann::json optimize(double omega, Molecule &mol, FockBuilder &F_0, FockBuilder &F_1);
+    nlohmann::json optimize(double omega, Molecule &mol, FockBuilder &F_0, std::vector<ResponseComponent> &block);
     void setOrthPrec(double prec) { this->orth_prec = prec; }
-    void setCheckpointFile(const std::string &file_x, const std::string &file_y) {
-        this->chkFileX = file_x;
-        this->chkFileY = file_y;
-    }
 
 protected:
     const bool dynamic;
     double orth_prec{mrcpp::MachineZero};
-    std::string chkFileX; ///< Name of checkpoint file
-    std::string chkFileY; ///< Name of checkpoint file
+
+    DoubleVector iterateOrbitals(double prec,
+                                 RankZeroOperator &V_0,
+                                 RankZeroOperator &V_1,
+                                 bool adjoint,
+                                 const HelmholtzVector &H,
+                                 const ComplexMatrix &F_mat,
+                                 OrbitalVector &Phi_0,
+                                 OrbitalVector &X_n,
+                                 KAIN &kain);
 
     void printProperty() const;
     void printParameters(double omega, const std::string &oper) const;
@@ -29,9 +29,13 @@
 #include "tensor/RankOneOperator.h"
 
 #include "surface_forces/lebedev.h"
+#include "surface_forces/treeEval.h"
 #include "surface_forces/xcStress.h"
+#include <algorithm>
+#include <array>
 #include <filesystem>
 #include <iostream>
+#include <limits>
 #include <string>
 
 #include <MRCPP/Timer>
@@ -69,6 +73,7 @@ MatrixXd nuclearEfield(const MatrixXd &nucPos, const VectorXd &nucCharge, const
         c2 = c * c;
         c3 = c2 * c;
         c3_times_sqrt_pi_times_three = 3. * std::sqrt(M_PI) * c3;
+#pragma omp parallel for schedule(static) private(r_vect, r, r2, r3)
         for (int j = 0; j < nGrid; j++) {
             r_vect = nucPos.row(i) - gridPos.row(j);
             r = r_vect.norm();
@@ -100,14 +105,7 @@ mrcpp::CompFunction<3> calcPotential(Density &rho, mrcpp::PoissonOperator &poiss
  * @param gridPos The positions of the grid points where the field should be evaluated. Shape (nGrid, 3).
  */
 MatrixXd electronicEfield(std::vector<Orbital> &negEfield, const MatrixXd &gridPos) {
-    int nGrid = gridPos.rows();
-    MatrixXd Efield = MatrixXd::Zero(nGrid, 3);
-    for (int i = 0; i < nGrid; i++) {
-        std::array<double, 3> pos = {gridPos(i, 0), gridPos(i, 1), gridPos(i, 2)};
-        Efield(i, 0) = -negEfield[0].real().evalf(pos);
-        Efield(i, 1) = -negEfield[1].real().evalf(pos);
-        Efield(i, 2) = -negEfield[2].real().evalf(pos);
-    }
+    MatrixXd Efield = -evalTrees({&negEfield[0].real(), &negEfield[1].real(), &negEfield[2].real()}, gridPos);
     return Efield;
 }
 
@@ -164,48 +162,34 @@ std::vector<Matrix3d> kineticStress(const Molecule &mol, OrbitalVector &Phi, std
     int nGrid = gridPos.rows();
     int nOrbs = Phi.size();
 
-    double StressArray[nGrid][3][3];
-
     double orbVal;
     std::vector<Matrix3d> stress(nGrid);
 
     Eigen::MatrixXd voigtStress = Eigen::MatrixXd::Zero(nGrid, 6);
 
-    std::array<double, 3> pos;
     double n1, n2, n3;
     double occ;
     for (int iOrb = 0; iOrb < Phi.size(); iOrb++) {
+        if (!mrcpp::mpi::my_func(iOrb)) continue;
         occ = Phi[iOrb].occ();
+        MatrixXd nablaGrid = evalTrees({&nablaPhi[iOrb][0].real(), &nablaPhi[iOrb][1].real(), &nablaPhi[iOrb][2].real()}, gridPos);
 
         for (int i = 0; i < nGrid; i++) {
-            if (mrcpp::mpi::my_func(iOrb)) {
-                pos[0] = gridPos(i, 0);
-                pos[1] = gridPos(i, 1);
-                pos[2] = gridPos(i, 2);
-                n1 = nablaPhi[iOrb][0].real().evalf(pos);
-                n2 = nablaPhi[iOrb][1].real().evalf(pos);
-                n3 = nablaPhi[iOrb][2].real().evalf(pos);
-                voigtStress(i, 0) -= occ * n1 * n1;
-                voigtStress(i, 1) -= occ * n2 * n2;
-                voigtStress(i, 2) -= occ * n3 * n3;
-                voigtStress(i, 5) -= occ * n1 * n2;
-                voigtStress(i, 4) -= occ * n1 * n3;
-                voigtStress(i, 3) -= occ * n2 * n3;
-            }
+            n1 = nablaGrid(i, 0);
+            n2 = nablaGrid(i, 1);
+            n3 = nablaGrid(i, 2);
+            voigtStress(i, 0) -= occ * n1 * n1;
+            voigtStress(i, 1) -= occ * n2 * n2;
+            voigtStress(i, 2) -= occ * n3 * n3;
+            voigtStress(i, 5) -= occ * n1 * n2;
+            voigtStress(i, 4) -= occ * n1 * n3;
+            voigtStress(i, 3) -= occ * n2 * n3;
         }
     }
     mrcpp::mpi::allreduce_matrix(voigtStress, mrcpp::mpi::comm_wrk);
-    for (int i = 0; i < nGrid; i++) {
-        pos[0] = gridPos(i, 0);
-        pos[1] = gridPos(i, 1);
-        pos[2] = gridPos(i, 2);
-        voigtStress(i, 0) += 0.25 * hessRho[0].real().evalf(pos);
-        voigtStress(i, 1) += 0.25 * hessRho[1].real().evalf(pos);
-        voigtStress(i, 2) += 0.25 * hessRho[2].real().evalf(pos);
-        voigtStress(i, 3) += 0.25 * hessRho[3].real().evalf(pos);
-        voigtStress(i, 4) += 0.25 * hessRho[4].real().evalf(pos);
-        voigtStress(i, 5) += 0.25 * hessRho[5].real().evalf(pos);
-    }
+    std::vector<const mrcpp::FunctionTree<3> *> hessTrees;
+    for (int j = 0; j < 6; j++) hessTrees.push_back(&hessRho[j].real());
+    voigtStress += 0.25 * evalTrees(hessTrees, gridPos);
 
     for (int i = 0; i < nGrid; i++) {
         stress[i] << voigtStress(i, 0), voigtStress(i, 5), voigtStress(i, 4), voigtStress(i, 5), voigtStress(i, 1), voigtStress(i, 3), voigtStress(i, 4), voigtStress(i, 3), voigtStress(i, 2);
@@ -215,6 +199,8 @@ std::vector<Matrix3d> kineticStress(const Molecule &mol, OrbitalVector &Phi, std
 
 /**
  * Calculates the distance to the nearest neighbor for each point in the given position matrix.
+ * The points are sorted into a uniform grid of cells with on average one point per cell, and
+ * for each point the shells of cells around it are searched until no closer point can be found.
  *
  * @param pos The matrix containing the positions of the points. Shape (nPoints, 3).
  * @return A vector containing the distances to the nearest neighbor for each point.
@@ -222,19 +208,46 @@ std::vector<Matrix3d> kineticStress(const Molecule &mol, OrbitalVector &Phi, std
 VectorXd distanceToNearestNeighbour(MatrixXd pos) {
     int n = pos.rows();
     VectorXd dist(n);
-    double temp;
     if (n == 1) {
         dist(0) = 1.0;
-    } else {
-        for (int i = 0; i < n; i++) {
-            dist(i) = (pos.row(i) - pos.row((i + 1) % n)).norm();
-            for (int j = 0; j < n; j++) {
-                if (i != j) {
-                    temp = (pos.row(i) - pos.row(j)).norm();
-                    if (temp < dist(i)) { dist(i) = temp; }
+        return dist;
+    }
+
+    Vector3d rMin = pos.colwise().minCoeff();
+    Vector3d rMax = pos.colwise().maxCoeff();
+    double cellSize = std::max((rMax - rMin).maxCoeff() / std::cbrt(static_cast<double>(n)), 1.0);
+    std::array<int, 3> dims;
+    for (int d = 0; d < 3; d++) dims[d] = static_cast<int>((rMax(d) - rMin(d)) / cellSize) + 1;
+    auto cellIndex = [&dims](int i, int j, int k) { return (i * dims[1] + j) * dims[2] + k; };
+
+    std::vector<std::vector<int>> cells(dims[0] * dims[1] * dims[2]);
+    std::vector<std::array<int, 3>> pointCell(n);
+    for (int i = 0; i < n; i++) {
+        for (int d = 0; d < 3; d++) pointCell[i][d] = std::min(static_cast<int>((pos(i, d) - rMin(d)) / cellSize), dims[d] - 1);
+        cells[cellIndex(pointCell[i][0], pointCell[i][1], pointCell[i][2])].push_back(i);
+    }
+    int maxShell = std::max({dims[0], dims[1], dims[2]});
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < n; i++) {
+        const auto &c = pointCell[i];
+        double best = std::numeric_limits<double>::max();
+        // points in shell s can be as close as (s - 1) * cellSize, since the point
+        // itself may lie anywhere in its own cell
+        for (int shell = 0; shell <= maxShell and best > (shell - 1) * cellSize; shell++) {
+            for (int a = std::max(c[0] - shell, 0); a <= std::min(c[0] + shell, dims[0] - 1); a++) {
+                for (int b = std::max(c[1] - shell, 0); b <= std::min(c[1] + shell, dims[1] - 1); b++) {
+                    for (int e = std::max(c[2] - shell, 0); e <= std::min(c[2] + shell, dims[2] - 1); e++) {
+                        // only the surface of the shell is new
+                        if (std::max({std::abs(a - c[0]), std::abs(b - c[1]), std::abs(e - c[2])}) != shell) continue;
+                        for (int j : cells[cellIndex(a, b, e)]) {
+                            if (j != i) best = std::min(best, (pos.row(i) - pos.row(j)).norm());
+                        }
+                    }
                 }
             }
         }
+        dist(i) = best;
     }
     return dist;
 }
@@ -347,25 +360,47 @@ Eigen::MatrixXd surface_forces(mrchem::Molecule &mol, mrchem::OrbitalVector &Phi
     Vector3d center;
     Eigen::MatrixXd forces = Eigen::MatrixXd::Zero(numAtoms, 3);
 
+    // Lebedev spheres of all atoms, stacked into one grid
+    std::vector<LebedevIntegrator> integrators;
+    std::vector<int> offsets(numAtoms + 1, 0);
     for (int iAtom = 0; iAtom < numAtoms; iAtom++) {
         radius = dist(iAtom) * radius_factor;
         coord = mol.getNuclei()[iAtom].getCoord();
         center << coord[0], coord[1], coord[2];
+        integrators.push_back(LebedevIntegrator(nLebPoints, radius, center));
+        offsets[iAtom + 1] = offsets[iAtom] + integrators[iAtom].n;
+    }
+    MatrixXd allPos(offsets[numAtoms], 3);
+    for (int iAtom = 0; iAtom < numAtoms; iAtom++) allPos.middleRows(offsets[iAtom], integrators[iAtom].n) = integrators[iAtom].getPoints();
 
-        LebedevIntegrator integrator(nLebPoints, radius, center);
-        MatrixXd gridPos = integrator.getPoints();
+    // the kinetic stress is distributed over the orbitals, so it is computed on all spheres at once
+    std::vector<Matrix3d> kstress = kineticStress(mol, Phi, nablaPhi, hessRho, prec, allPos);
+
+    // the remaining stress only needs the density and potentials, so the spheres are distributed
+    std::vector<int> myAtoms;
+    for (int iAtom = 0; iAtom < numAtoms; iAtom++) {
+        if (iAtom % mrcpp::mpi::wrk_size == mrcpp::mpi::wrk_rank) myAtoms.push_back(iAtom);
+    }
+    std::vector<int> myOffsets(myAtoms.size() + 1, 0);
+    for (int n = 0; n < myAtoms.size(); n++) myOffsets[n + 1] = myOffsets[n] + integrators[myAtoms[n]].n;
+    MatrixXd myPos(myOffsets[myAtoms.size()], 3);
+    for (int n = 0; n < myAtoms.size(); n++) myPos.middleRows(myOffsets[n], integrators[myAtoms[n]].n) = integrators[myAtoms[n]].getPoints();
+
+    // getXCStress computes the densities, so it is called on all ranks
+    std::vector<Matrix3d> xcStress = getXCStress(mrdft_p, *xc_pot_vector, std::make_shared<mrchem::OrbitalVector>(Phi), std::make_shared<mrchem::NablaOperator>(nabla), myPos, xc_spin, prec);
+    std::vector<Matrix3d> mstress = maxwellStress(mol, negEfield, myPos, prec);
+
+    for (int n = 0; n < myAtoms.size(); n++) {
+        int iAtom = myAtoms[n];
+        const auto &integrator = integrators[iAtom];
         VectorXd weights = integrator.getWeights();
         MatrixXd normals = integrator.getNormals();
-        std::vector<Matrix3d> xcStress = getXCStress(mrdft_p, *xc_pot_vector, std::make_shared<mrchem::OrbitalVector>(Phi), std::make_shared<mrchem::NablaOperator>(nabla), gridPos, xc_spin, prec);
-
-        std::vector<Matrix3d> kstress = kineticStress(mol, Phi, nablaPhi, hessRho, prec, gridPos);
-        std::vector<Matrix3d> mstress = maxwellStress(mol, negEfield, gridPos, prec);
-        std::vector<Matrix3d> stress(integrator.n);
         for (int i = 0; i < integrator.n; i++) {
-            stress[i] = xcStress[i] + kstress[i] + mstress[i];
-            forces.row(iAtom) -= stress[i] * normals.row(i).transpose() * weights(i);
+            Matrix3d stress = xcStress[myOffsets[n] + i] + kstress[offsets[iAtom] + i] + mstress[myOffsets[n] + i];
+            forces.row(iAtom) -= stress * normals.row(i).transpose() * weights(i);
         }
     }
+    mrcpp::mpi::allreduce_matrix(forces, mrcpp::mpi::comm_wrk);
 
     hess.clear();
     nabla.clear();
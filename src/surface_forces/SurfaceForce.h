@@ -11,6 +11,7 @@
 namespace surface_force {
 
 // Function declaration
+Eigen::VectorXd distanceToNearestNeighbour(Eigen::MatrixXd pos);
 Eigen::MatrixXd surface_forces(mrchem::Molecule &mol, mrchem::OrbitalVector &Phi, double prec, const json &json_fock, std::string leb_prec, double radius_factor);
 
 } // namespace surface_force
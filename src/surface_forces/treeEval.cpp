@@ -0,0 +1,158 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include "surface_forces/treeEval.h"
+
+#include <MRCPP/trees/FunctionNode.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace surface_force {
+
+/**
+ * @brief Evaluate several MW functions in a set of points
+ *
+ * Replaces one FunctionTree::evalf call per point and function. For each function the
+ * points are sorted by the leaf node that contains them. As in FunctionNode::evalf, the
+ * leaf is evaluated through its children, so that its wavelet part is included: the
+ * scaling coefficients of the children are reconstructed once per leaf, and all points
+ * of the leaf are evaluated against the child that contains them, with the tensor
+ * product contracted one dimension at a time (k^3 + k^2 + k instead of 3 k^3 operations).
+ * The scaling basis values of a point only depend on the node, so they are reused
+ * between consecutive functions that share the grid (e.g. the components of a gradient).
+ */
+Eigen::MatrixXd evalTrees(const std::vector<const mrcpp::FunctionTree<3> *> &trees, const Eigen::MatrixXd &gridPos) {
+    int nGrid = gridPos.rows();
+    int nFuncs = trees.size();
+    Eigen::MatrixXd values = Eigen::MatrixXd::Zero(nGrid, nFuncs);
+    if (nGrid == 0 or nFuncs == 0) return values;
+
+    const auto &mra = trees[0]->getMRA();
+    const auto &basis = mra.getScalingBasis();
+    const auto sf = mra.getWorldBox().getScalingFactors();
+    const int kp1 = basis.getScalingOrder() + 1;
+    const int kp1_d = kp1 * kp1 * kp1;
+    const int nCoefs = trees[0]->getTDim() * kp1_d;
+
+    // adjust for the scaling factors included in the basis
+    double sfNorm = 1.0;
+    for (int d = 0; d < 3; d++) sfNorm /= std::sqrt(sf[d]);
+
+    // points in the unscaled coordinates of the trees
+    std::vector<mrcpp::Coord<3>> args(nGrid);
+    std::vector<char> inside(nGrid);
+    for (int p = 0; p < nGrid; p++) {
+        for (int d = 0; d < 3; d++) args[p][d] = gridPos(p, d) / sf[d];
+        inside[p] = trees[0]->getRootBox().isInside(args[p]);
+    }
+
+    // child node of the last evaluation in each point, and the basis values in that node
+    std::vector<int> lastScale(nGrid, std::numeric_limits<int>::min());
+    std::vector<std::array<int, 3>> lastTransl(nGrid);
+    std::vector<Eigen::MatrixXd> basisVals(nGrid, Eigen::MatrixXd::Zero(kp1, 3));
+
+    std::vector<const mrcpp::FunctionNode<3> *> leaves(nGrid);
+    std::vector<int> order(nGrid);
+    for (int f = 0; f < nFuncs; f++) {
+        const auto &tree = *trees[f];
+
+#pragma omp parallel for schedule(static)
+        for (int p = 0; p < nGrid; p++) {
+            leaves[p] = nullptr;
+            if (inside[p]) leaves[p] = &static_cast<const mrcpp::FunctionNode<3> &>(tree.getNodeOrEndNode(args[p]));
+        }
+
+        // sort the points by leaf, and evaluate leaf by leaf
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&leaves](int a, int b) { return std::less<const void *>()(leaves[a], leaves[b]); });
+        std::vector<int> groups;
+        for (int n = 0; n < nGrid; n++) {
+            if (n == 0 or leaves[order[n]] != leaves[order[n - 1]]) groups.push_back(n);
+        }
+        groups.push_back(nGrid);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int g = 0; g < groups.size() - 1; g++) {
+            const auto *node = leaves[order[groups[g]]];
+            if (node == nullptr) continue;
+
+            // scaling coefficients of the children, from the scaling and wavelet coefficients of the leaf
+            Eigen::VectorXd childCoefs = Eigen::Map<const Eigen::VectorXd>(node->getCoefs(), nCoefs);
+            mrcpp::MWNode<3> scratch(*node, true, false); // copy node, but do not copy coef
+            double *ownCoefs = scratch.getCoefs();
+            scratch.attachCoefs(childCoefs.data());
+            scratch.mwTransform(mrcpp::Reconstruction);
+            scratch.attachCoefs(ownCoefs); // restablish the original link (for proper destructor behaviour)
+
+            const int scale = node->getScale() + 1;
+            const auto l = node->getTranslation();
+            const double two_n = std::pow(2.0, scale);
+            const double norm = sfNorm * std::pow(2.0, 1.5 * scale);
+
+            for (int n = groups[g]; n < groups[g + 1]; n++) {
+                const int p = order[n];
+
+                // child containing the point
+                int cIdx = 0;
+                std::array<int, 3> transl;
+                mrcpp::Coord<3> arg;
+                for (int d = 0; d < 3; d++) {
+                    arg[d] = two_n * args[p][d] - 2 * l[d];
+                    int bit = (arg[d] >= 1.0) ? 1 : 0;
+                    transl[d] = 2 * l[d] + bit;
+                    arg[d] -= bit;
+                    cIdx += bit << d;
+                }
+
+                auto &vals = basisVals[p];
+                if (scale != lastScale[p] or transl != lastTransl[p]) {
+                    basis.evalf(arg.data(), vals);
+                    lastScale[p] = scale;
+                    lastTransl[p] = transl;
+                }
+                const double *coefs = childCoefs.data() + cIdx * kp1_d;
+                double result = 0.0;
+                for (int i2 = 0; i2 < kp1; i2++) {
+                    double s1 = 0.0;
+                    for (int i1 = 0; i1 < kp1; i1++) {
+                        const double *c = coefs + kp1 * (i1 + kp1 * i2);
+                        double s0 = 0.0;
+#pragma omp simd reduction(+ : s0)
+                        for (int i0 = 0; i0 < kp1; i0++) s0 += c[i0] * vals(i0, 0);
+                        s1 += s0 * vals(i1, 1);
+                    }
+                    result += s1 * vals(i2, 2);
+                }
+                values(p, f) = norm * result;
+            }
+        }
+    }
+    return values;
+}
+
+} // namespace surface_force
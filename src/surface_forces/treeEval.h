@@ -0,0 +1,43 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <MRCPP/MWFunctions>
+#include <vector>
+
+namespace surface_force {
+
+/**
+ * @brief Evaluate several MW functions in a set of points
+ *
+ * @param trees The functions to evaluate, all defined on the same MRA
+ * @param gridPos The positions of the points. Shape (nGrid, 3).
+ * @return The function values, shape (nGrid, nFuncs)
+ */
+Eigen::MatrixXd evalTrees(const std::vector<const mrcpp::FunctionTree<3> *> &trees, const Eigen::MatrixXd &gridPos);
+
+} // namespace surface_force
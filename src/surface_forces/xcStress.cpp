@@ -5,6 +5,7 @@
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/density_utils.h"
 #include "qmoperators/one_electron/NablaOperator.h"
+#include "surface_forces/treeEval.h"
 
 using namespace Eigen;
 using namespace mrchem;
@@ -69,13 +70,10 @@ std::vector<Matrix3d> xcGGAStress(unique_ptr<mrdft::MRDFT> &mrdft_p, mrcpp::Func
     inp.col(3) = nablaRhoGrid.col(2);
     Eigen::MatrixXd xcOUT = mrdft_p->functional().evaluate_transposed(inp);
     std::vector<Matrix3d> out(nGrid);
-    std::array<double, 3> pos;
+    MatrixXd potGrid = evalTrees({std::get<1>(xc_pots[0])}, gridPos);
     for (int i = 0; i < rhoGrid.rows(); i++) {
         out[i] = Matrix3d::Zero();
-        pos[0] = gridPos(i, 0);
-        pos[1] = gridPos(i, 1);
-        pos[2] = gridPos(i, 2);
-        for (int j = 0; j < 3; j++) { out[i](j, j) = xcOUT(i, 0) - rhoGrid(i) * std::get<1>(xc_pots[0])->evalf(pos); }
+        for (int j = 0; j < 3; j++) { out[i](j, j) = xcOUT(i, 0) - rhoGrid(i) * potGrid(i, 0); }
         for (int j1 = 0; j1 < 3; j1++) {
             for (int j2 = 0; j2 < 3; j2++) { out[i](j1, j2) = out[i](j1, j2) - xcOUT(i, 2 + j1) * nablaRhoGrid(i, j2); }
         }
@@ -112,13 +110,10 @@ std::vector<Matrix3d> xcGGASpinStress(unique_ptr<mrdft::MRDFT> &mrdft_p,
     inp.col(6) = nablaRhoGridBeta.col(1);
     inp.col(7) = nablaRhoGridBeta.col(2);
     Eigen::MatrixXd xc = mrdft_p->functional().evaluate_transposed(inp);
-    std::array<double, 3> pos;
+    MatrixXd potGrid = evalTrees({std::get<1>(xc_pots[0]), std::get<1>(xc_pots[1])}, gridPos);
     for (int i = 0; i < rhoGridAlpha.rows(); i++) {
         out[i] = Matrix3d::Zero();
-        pos[0] = gridPos(i, 0);
-        pos[1] = gridPos(i, 1);
-        pos[2] = gridPos(i, 2);
-        for (int j = 0; j < 3; j++) { out[i](j, j) = xc(i, 0) - std::get<1>(xc_pots[0])->evalf(pos) * rhoGridAlpha(i) - std::get<1>(xc_pots[1])->evalf(pos) * rhoGridBeta(i); }
+        for (int j = 0; j < 3; j++) { out[i](j, j) = xc(i, 0) - potGrid(i, 0) * rhoGridAlpha(i) - potGrid(i, 1) * rhoGridBeta(i); }
         for (int j1 = 0; j1 < 3; j1++) {
             for (int j2 = 0; j2 < 3; j2++) { out[i](j1, j2) = out[i](j1, j2) - xc(i, 3 + j1) * nablaRhoGridAlpha(i, j2) - xc(i, 6 + j1) * nablaRhoGridBeta(i, j2); }
         }
@@ -148,7 +143,6 @@ std::vector<Eigen::Matrix3d> getXCStress(unique_ptr<mrdft::MRDFT> &mrdft_p,
     bool isHybrid = mrdft_p->functional().isHybrid();
     if (isHybrid) { MSG_ABORT("Exact exchange is not implemented for forces computed with surface integrals"); }
 
-    std::array<double, 3> pos;
     int nGrid = gridPos.rows();
 
     vector<Matrix3d> xcStress;
@@ -161,31 +155,17 @@ std::vector<Eigen::Matrix3d> getXCStress(unique_ptr<mrdft::MRDFT> &mrdft_p,
         mrchem::density::compute(prec, rhoA, *phi, DensityType::Alpha);
         mrchem::density::compute(prec, rhoB, *phi, DensityType::Beta);
 
-        for (int i = 0; i < nGrid; i++) { // compute density on grid
-            pos[0] = gridPos(i, 0);
-            pos[1] = gridPos(i, 1);
-            pos[2] = gridPos(i, 2);
-            rhoGridAlpha(i) = rhoA.real().evalf(pos);
-            rhoGridBeta(i) = rhoB.real().evalf(pos);
-        }
+        // compute density on grid
+        MatrixXd rhoGridSpin = evalTrees({&rhoA.real(), &rhoB.real()}, gridPos);
+        rhoGridAlpha.col(0) = rhoGridSpin.col(0);
+        rhoGridBeta.col(0) = rhoGridSpin.col(1);
 
         if (isGGA) {
             mrchem::NablaOperator nablaOP = *nabla;
             std::vector<mrchem::Orbital> nablaRhoAlpha = nablaOP(rhoA);
             std::vector<mrchem::Orbital> nablaRhoBeta = nablaOP(rhoB);
-            MatrixXd nablaRhoGridAlpha(nGrid, 3);
-            MatrixXd nablaRhoGridBeta(nGrid, 3);
-            for (int i = 0; i < nGrid; i++) {
-                pos[0] = gridPos(i, 0);
-                pos[1] = gridPos(i, 1);
-                pos[2] = gridPos(i, 2);
-                nablaRhoGridAlpha(i, 0) = nablaRhoAlpha[0].real().evalf(pos);
-                nablaRhoGridAlpha(i, 1) = nablaRhoAlpha[1].real().evalf(pos);
-                nablaRhoGridAlpha(i, 2) = nablaRhoAlpha[2].real().evalf(pos);
-                nablaRhoGridBeta(i, 0) = nablaRhoBeta[0].real().evalf(pos);
-                nablaRhoGridBeta(i, 1) = nablaRhoBeta[1].real().evalf(pos);
-                nablaRhoGridBeta(i, 2) = nablaRhoBeta[2].real().evalf(pos);
-            }
+            MatrixXd nablaRhoGridAlpha = evalTrees({&nablaRhoAlpha[0].real(), &nablaRhoAlpha[1].real(), &nablaRhoAlpha[2].real()}, gridPos);
+            MatrixXd nablaRhoGridBeta = evalTrees({&nablaRhoBeta[0].real(), &nablaRhoBeta[1].real(), &nablaRhoBeta[2].real()}, gridPos);
 
             xcStress = xcGGASpinStress(mrdft_p, xc_pots, rhoGridAlpha, rhoGridBeta, nablaRhoGridAlpha, nablaRhoGridBeta, gridPos);
         } else {
@@ -197,25 +177,12 @@ std::vector<Eigen::Matrix3d> getXCStress(unique_ptr<mrdft::MRDFT> &mrdft_p,
         mrchem::Density rho(false);
         mrchem::density::compute(prec, rho, *phi, DensityType::Total);
 
-        for (int i = 0; i < nGrid; i++) { // compute density on grid
-            pos[0] = gridPos(i, 0);
-            pos[1] = gridPos(i, 1);
-            pos[2] = gridPos(i, 2);
-            rhoGrid(i) = rho.real().evalf(pos);
-        }
+        rhoGrid = evalTrees({&rho.real()}, gridPos); // compute density on grid
 
         if (isGGA) {
             mrchem::NablaOperator nablaOP = *nabla;
             std::vector<mrchem::Orbital> nablaRho = nablaOP(rho);
-            MatrixXd nablaRhoGrid(nGrid, 3);
-            for (int i = 0; i < nGrid; i++) {
-                pos[0] = gridPos(i, 0);
-                pos[1] = gridPos(i, 1);
-                pos[2] = gridPos(i, 2);
-                nablaRhoGrid(i, 0) = nablaRho[0].real().evalf(pos);
-                nablaRhoGrid(i, 1) = nablaRho[1].real().evalf(pos);
-                nablaRhoGrid(i, 2) = nablaRho[2].real().evalf(pos);
-            }
+            MatrixXd nablaRhoGrid = evalTrees({&nablaRho[0].real(), &nablaRho[1].real(), &nablaRho[2].real()}, gridPos);
             xcStress = xcGGAStress(mrdft_p, xc_pots, rhoGrid, nablaRhoGrid, gridPos);
         } else {
             xcStress = xcLDAStress(mrdft_p, rhoGrid);
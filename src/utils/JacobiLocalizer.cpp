@@ -0,0 +1,173 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include "MRCPP/Printer"
+
+#include "utils/JacobiLocalizer.h"
+
+#include "qmfunctions/Orbital.h"
+#include "qmfunctions/orbital_utils.h"
+
+namespace mrchem {
+
+/** Compute the position matrices <i|R_x|j>,<i|R_y|j>,<i|R_z|j>
+ */
+JacobiLocalizer::JacobiLocalizer(double thrs, OrbitalVector &Phi)
+        : N(Phi.size())
+        , thrs(thrs) {
+    if (this->N < 2) MSG_ERROR("Cannot localize less than two orbitals");
+    for (int i = 0; i < this->N; i++) {
+        if (Phi[i].spin() != Phi[0].spin()) MSG_ERROR("Spins must be separated before localization");
+    }
+    this->R = orbital::calc_moment_matrices(Phi, 1);
+    this->total_U = DoubleMatrix::Identity(this->N, this->N);
+    this->rotated = std::vector<bool>(this->N, false);
+}
+
+/** compute the value of
+ * f$  \sum_{i=1,N}\langle i| {\bf R}| i \rangle^2\f$
+ */
+double JacobiLocalizer::functional() const {
+    double s1 = 0.0;
+    for (const auto &R_d : this->R) s1 += R_d.diagonal().squaredNorm();
+    return s1;
+}
+
+/** Optimal rotation angle of the pair (i,j), and the resulting gain of the functional
+ *
+ * Rotating i' = cos(t) i + sin(t) j, j' = -sin(t) i + cos(t) j changes the
+ * functional by A (1 - cos(4t)) + B sin(4t), which is maximal for
+ * t = atan2(B, -A) / 4 with the gain A + sqrt(A^2 + B^2).
+ */
+double JacobiLocalizer::calc_pair(int i, int j, double &theta) const {
+    double A = 0.0;
+    double B = 0.0;
+    for (const auto &R_d : this->R) {
+        double r_ij = R_d(i, j);
+        double r_diff = R_d(i, i) - R_d(j, j);
+        A += r_ij * r_ij - 0.25 * r_diff * r_diff;
+        B += r_ij * r_diff;
+    }
+    theta = 0.25 * std::atan2(B, -A);
+    return A + std::sqrt(A * A + B * B);
+}
+
+/** One sweep over all pairs, in rounds of disjoint pairs
+ *
+ * The angles of a round are computed from the matrices before the round, the
+ * column rotations are then applied in parallel, followed by the row rotations.
+ * Returns the number of rotations that were applied.
+ */
+int JacobiLocalizer::sweep(double pair_thrs) {
+    // round-robin ordering, with a dummy index N for an odd number of orbitals
+    int M = this->N + (this->N % 2);
+    std::vector<int> order(M);
+    for (int k = 0; k < M; k++) order[k] = k;
+
+    int n_rot = 0;
+    for (int round = 0; round < M - 1; round++) {
+        std::vector<std::tuple<int, int, double>> pairs;
+        for (int k = 0; k < M / 2; k++) {
+            int i = std::min(order[k], order[M - 1 - k]);
+            int j = std::max(order[k], order[M - 1 - k]);
+            if (j >= this->N) continue;
+            double theta = 0.0;
+            if (calc_pair(i, j, theta) > pair_thrs) pairs.push_back({i, j, theta});
+        }
+        int n_pairs = pairs.size();
+
+        // columns: R <- R G, U <- U G
+#pragma omp parallel for schedule(static)
+        for (int p = 0; p < n_pairs; p++) {
+            auto [i, j, theta] = pairs[p];
+            double c = std::cos(theta);
+            double s = std::sin(theta);
+            for (auto &R_d : this->R) {
+                DoubleVector col_i = R_d.col(i);
+                R_d.col(i) = c * col_i + s * R_d.col(j);
+                R_d.col(j) = c * R_d.col(j) - s * col_i;
+            }
+            DoubleVector col_i = this->total_U.col(i);
+            this->total_U.col(i) = c * col_i + s * this->total_U.col(j);
+            this->total_U.col(j) = c * this->total_U.col(j) - s * col_i;
+        }
+        // rows: R <- G^T R
+#pragma omp parallel for schedule(static)
+        for (int p = 0; p < n_pairs; p++) {
+            auto [i, j, theta] = pairs[p];
+            double c = std::cos(theta);
+            double s = std::sin(theta);
+            for (auto &R_d : this->R) {
+                DoubleVector row_i = R_d.row(i);
+                R_d.row(i) = c * row_i.transpose() + s * R_d.row(j);
+                R_d.row(j) = c * R_d.row(j) - s * row_i.transpose();
+            }
+        }
+        for (auto &[i, j, theta] : pairs) {
+            this->rotated[i] = true;
+            this->rotated[j] = true;
+        }
+        n_rot += n_pairs;
+
+        // keep the first index fixed, rotate the others one step
+        std::rotate(order.begin() + 1, order.end() - 1, order.end());
+    }
+    return n_rot;
+}
+
+/** Run sweeps until the functional changes by less than the threshold
+ *
+ * Pairs that cannot improve the functional by more than the threshold divided
+ * by the number of pairs are not rotated. All ranks hold the same matrices and
+ * run identical sweeps, so no communication is needed.
+ *
+ * Returns the number of sweeps, or -1 if not converged.
+ */
+int JacobiLocalizer::localize(int max_sweeps) {
+    double pair_thrs = 2.0 * this->thrs / (this->N * (this->N - 1));
+    double f_old = functional();
+    for (int n = 1; n <= max_sweeps; n++) {
+        int n_rot = sweep(pair_thrs);
+        double f_new = functional();
+        if (n_rot == 0 or std::abs(f_new - f_old) < this->thrs) return n;
+        f_old = f_new;
+    }
+    return -1;
+}
+
+/** Indices of the orbitals that are mixed by the total rotation */
+std::vector<int> JacobiLocalizer::getRotatedIndices() const {
+    std::vector<int> idx;
+    for (int i = 0; i < this->N; i++) {
+        if (this->rotated[i]) idx.push_back(i);
+    }
+    return idx;
+}
+
+} // namespace mrchem
@@ -0,0 +1,65 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mrchem.h"
+#include "qmfunctions/qmfunction_fwd.h"
+
+/** Foster-Boys localization by sweeps of pairwise Jacobi rotations, maximizing
+ * f$  \sum_{i=1,N}\langle i| {\bf R}| i \rangle^2\f$
+ * for orthonormal, real orbitals. The optimal angle of each pair is known in
+ * closed form. A sweep visits all pairs in N-1 rounds of N/2 disjoint pairs
+ * (round-robin ordering), and the rotations within a round are applied together.
+ * Pairs whose maximal gain is below the threshold are skipped, so that the
+ * rotation stays close to the identity for nearly localized orbitals.
+ */
+
+namespace mrchem {
+
+class JacobiLocalizer final {
+public:
+    JacobiLocalizer(double thrs, OrbitalVector &Phi);
+
+    int localize(int max_sweeps = 100);
+
+    const DoubleMatrix &getTotalU() const { return this->total_U; }
+    std::vector<int> getRotatedIndices() const;
+
+protected:
+    int N;                        // number of orbitals
+    double thrs;                  // convergence threshold on the functional
+    std::vector<DoubleMatrix> R;  // <i|R_x|j>,<i|R_y|j>,<i|R_z|j> in the rotated basis
+    DoubleMatrix total_U;         // the rotation matrix of the orbitals
+    std::vector<bool> rotated;    // orbitals touched by at least one rotation
+
+    double functional() const;
+    double calc_pair(int i, int j, double &theta) const;
+    int sweep(double pair_thrs);
+};
+
+} // namespace mrchem
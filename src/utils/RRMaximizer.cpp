@@ -48,39 +48,46 @@ RRMaximizer::RRMaximizer(double prec, OrbitalVector &Phi) {
     this->r_i = DoubleMatrix(this->N, 3 * this->N);
 
     // Make R matrix
-    PositionOperator r;
-    r.setup(prec);
-
-    RankZeroOperator &r_x = r[0];
-    RankZeroOperator &r_y = r[1];
-    RankZeroOperator &r_z = r[2];
-
-    ComplexMatrix R_x = ComplexMatrix::Zero(Phi.size(), Phi.size());
-    ComplexMatrix R_y = ComplexMatrix::Zero(Phi.size(), Phi.size());
-    ComplexMatrix R_z = ComplexMatrix::Zero(Phi.size(), Phi.size());
-
-    OrbitalVector xPhi_Vec = r_x(Phi);
-    r_x.clear();
-    R_x = orbital::calc_overlap_matrix(Phi, xPhi_Vec);
-    for (int i = 0; i < Phi.size(); i++) {
-        if (!mrcpp::mpi::my_func(i)) continue;
-        xPhi_Vec[i].free();
-    }
+    ComplexMatrix R_x, R_y, R_z;
+    bool all_real = true;
+    for (auto &phi_i : Phi) all_real = all_real and phi_i.isreal();
+    if (all_real) {
+        // all three position matrices in one traversal of each orbital pair
+        auto R_d = orbital::calc_moment_matrices(Phi, 1);
+        R_x = R_d[0].cast<ComplexDouble>();
+        R_y = R_d[1].cast<ComplexDouble>();
+        R_z = R_d[2].cast<ComplexDouble>();
+    } else {
+        PositionOperator r;
+        r.setup(prec);
+
+        RankZeroOperator &r_x = r[0];
+        RankZeroOperator &r_y = r[1];
+        RankZeroOperator &r_z = r[2];
+
+        OrbitalVector xPhi_Vec = r_x(Phi);
+        r_x.clear();
+        R_x = orbital::calc_overlap_matrix(Phi, xPhi_Vec);
+        for (int i = 0; i < Phi.size(); i++) {
+            if (!mrcpp::mpi::my_func(i)) continue;
+            xPhi_Vec[i].free();
+        }
 
-    OrbitalVector yPhi_Vec = r_y(Phi);
-    r_y.clear();
-    R_y = orbital::calc_overlap_matrix(Phi, yPhi_Vec);
-    for (int i = 0; i < Phi.size(); i++) {
-        if (!mrcpp::mpi::my_func(i)) continue;
-        yPhi_Vec[i].free();
-    }
+        OrbitalVector yPhi_Vec = r_y(Phi);
+        r_y.clear();
+        R_y = orbital::calc_overlap_matrix(Phi, yPhi_Vec);
+        for (int i = 0; i < Phi.size(); i++) {
+            if (!mrcpp::mpi::my_func(i)) continue;
+            yPhi_Vec[i].free();
+        }
 
-    OrbitalVector zPhi_Vec = r_z(Phi);
-    r_z.clear();
-    R_z = orbital::calc_overlap_matrix(Phi, zPhi_Vec);
-    for (int i = 0; i < Phi.size(); i++) {
-        if (!mrcpp::mpi::my_func(i)) continue;
-        zPhi_Vec[i].free();
+        OrbitalVector zPhi_Vec = r_z(Phi);
+        r_z.clear();
+        R_z = orbital::calc_overlap_matrix(Phi, zPhi_Vec);
+        for (int i = 0; i < Phi.size(); i++) {
+            if (!mrcpp::mpi::my_func(i)) continue;
+            zPhi_Vec[i].free();
+        }
     }
 
     for (int i = 0; i < this->N; i++) {
@@ -0,0 +1,173 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include <MRCPP/MWFunctions>
+#include <MRCPP/Parallel>
+#include <MRCPP/Printer>
+
+#include "mpi_utils.h"
+
+namespace mrchem {
+
+namespace mpi_utils {
+void recursive_doubling(double prec, mrcpp::CompFunction<3> &func, int tag, MPI_Comm comm);
+void copy_function(mrcpp::CompFunction<3> &out, mrcpp::CompFunction<3> &inp);
+} // namespace mpi_utils
+
+/** @brief Add up function contributions from all ranks and distribute the result
+ *
+ * @param prec: precision used for cropping the (intermediate) sums
+ * @param func_tot: output function, in shared memory if func_tot.isShared()
+ * @param func_loc: local contribution, will be overwritten
+ * @param tag: MPI tag used for the shared memory distribution
+ *
+ * MPI: with mrcpp::mpi::reduce_function() followed by broadcast_function() the
+ *      full sum passes through, and is cropped by, the grand master. Here the
+ *      sum is instead computed by recursive doubling, where every rank takes
+ *      part in the reduction and all ranks end up with the total without a
+ *      separate broadcast step (see recursive_doubling()).
+ *
+ *      With shared memory the contributions are first reduced within each
+ *      shared memory group, the recursive doubling runs between the share
+ *      masters only, and the result is distributed through shared memory.
+ *
+ *      In numerically exact runs all contributions are added on their union
+ *      grid on the grand master before the result is cropped and broadcast,
+ *      as this is the only way to guarantee results that are independent of
+ *      the orbital distribution.
+ */
+void mpi_utils::allreduce_function(double prec, mrcpp::CompFunction<3> &func_tot, mrcpp::CompFunction<3> &func_loc, int tag) {
+    if (not func_tot.hasReal()) func_tot.alloc(1);
+
+    if (mrcpp::mpi::numerically_exact) {
+        // Add up local contributions into the grand master
+        mrcpp::mpi::reduce_function(-1.0, func_loc, mrcpp::mpi::comm_wrk);
+        // If numerically exact the grid is huge at this point
+        if (mrcpp::mpi::grand_master()) func_loc.crop(prec);
+
+        if (func_tot.isShared()) {
+            // MPI grand master distributes to shared masters
+            mrcpp::mpi::broadcast_function(func_loc, mrcpp::mpi::comm_sh_group);
+            // MPI shared masters copies the function into final memory
+            if (mrcpp::mpi::share_master()) mpi_utils::copy_function(func_tot, func_loc);
+            // MPI share masters distributes to their sharing ranks
+            mrcpp::mpi::share_function(func_tot, 0, tag, mrcpp::mpi::comm_share);
+        } else {
+            // MPI grand master distributes to all ranks
+            mrcpp::mpi::broadcast_function(func_loc, mrcpp::mpi::comm_wrk);
+            // All MPI ranks copies the function into final memory
+            mpi_utils::copy_function(func_tot, func_loc);
+        }
+    } else if (func_tot.isShared()) {
+        // Add up local contributions into the share masters
+        mrcpp::mpi::reduce_function(prec, func_loc, mrcpp::mpi::comm_share);
+        if (mrcpp::mpi::share_master()) {
+            // MPI shared masters sum up contributions from all groups
+            mpi_utils::recursive_doubling(prec, func_loc, tag, mrcpp::mpi::comm_sh_group);
+            // MPI shared masters copies the function into final memory
+            mpi_utils::copy_function(func_tot, func_loc);
+        }
+        // MPI share masters distributes to their sharing ranks
+        mrcpp::mpi::share_function(func_tot, 0, tag, mrcpp::mpi::comm_share);
+    } else {
+        // All MPI ranks sum up contributions from all ranks
+        mpi_utils::recursive_doubling(prec, func_loc, tag, mrcpp::mpi::comm_wrk);
+        // All MPI ranks copies the function into final memory
+        mpi_utils::copy_function(func_tot, func_loc);
+    }
+}
+
+/** @brief Allreduce of a function by recursive doubling
+ *
+ * @param prec: precision used for cropping the intermediate sums
+ * @param func: local contribution on input, total sum on output
+ * @param tag: MPI tag
+ * @param comm: MPI communicator
+ *
+ * In round k every rank exchanges its current partial sum with the rank 2^k
+ * away (rank XOR 2^k), and adds the received function to its own. After
+ * log2(N) rounds all ranks hold the total sum. The two ranks of a pair add the
+ * same two functions, so the results are identical on all ranks. Ranks beyond
+ * the largest power of two fold their contribution into a partner before the
+ * first round, and receive the final result after the last.
+ */
+void mpi_utils::recursive_doubling(double prec, mrcpp::CompFunction<3> &func, int tag, MPI_Comm comm) {
+    int rank = 0;
+    int size = 1;
+#ifdef MRCPP_HAS_MPI
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+#endif
+    if (size < 2) return;
+
+    int p2 = 1;
+    while (2 * p2 <= size) p2 *= 2;
+    int n_extra = size - p2;
+
+    // Fold in the ranks beyond the largest power of two
+    if (rank >= p2) {
+        mrcpp::mpi::send_function(func, rank - p2, tag, comm);
+    } else if (rank < n_extra) {
+        mrcpp::CompFunction<3> func_i(false);
+        mrcpp::mpi::recv_function(func_i, rank + p2, tag, comm);
+        func.add(1.0, func_i); // Extends to union grid
+        func.crop(prec);       // Truncates to given precision
+        func_i.free();
+    }
+
+    // Pairwise exchange of partial sums, lower rank sends first
+    if (rank < p2) {
+        for (int dist = 1; dist < p2; dist *= 2) {
+            int partner = rank ^ dist;
+            mrcpp::CompFunction<3> func_i(false);
+            if (rank < partner) {
+                mrcpp::mpi::send_function(func, partner, tag, comm);
+                mrcpp::mpi::recv_function(func_i, partner, tag, comm);
+            } else {
+                mrcpp::mpi::recv_function(func_i, partner, tag, comm);
+                mrcpp::mpi::send_function(func, partner, tag, comm);
+            }
+            func.add(1.0, func_i); // Extends to union grid
+            func.crop(prec);       // Truncates to given precision
+            func_i.free();
+        }
+    }
+
+    // Return the total sum to the folded ranks
+    if (rank >= p2) {
+        func.free();
+        mrcpp::mpi::recv_function(func, rank - p2, tag, comm);
+    } else if (rank < n_extra) {
+        mrcpp::mpi::send_function(func, rank + p2, tag, comm);
+    }
+}
+
+/** @brief Copy real function into pre-allocated (possibly shared) memory */
+void mpi_utils::copy_function(mrcpp::CompFunction<3> &out, mrcpp::CompFunction<3> &inp) {
+    mrcpp::copy_grid(out.real(), inp.real());
+    mrcpp::copy_func(out.real(), inp.real());
+}
+
+} // namespace mrchem
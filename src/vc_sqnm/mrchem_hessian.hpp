@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <MRCPP/Parallel>
+#include <MRCPP/Printer>
+#include <MRCPP/Timer>
+
+#include "driver.h"
+#include "mrchem.h"
+#include "mrenv.h"
+
+#include "chemistry/Molecule.h"
+#include "chemistry/PhysicalConstants.h"
+#include "qmfunctions/orbital_utils.h"
+#include "utils/print_utils.h"
+#include "vc_sqnm/mrchem_optimizer.hpp"
+
+#include <Eigen/Dense>
+
+using json = nlohmann::json;
+using namespace mrchem;
+
+/**
+ * @brief Independent groups of work processes that compute displaced geometries concurrently.
+ *
+ * While a group is entered, mrcpp::mpi::comm_wrk, wrk_rank and wrk_size describe the group
+ * instead of all work processes, so that everything that distributes orbitals over comm_wrk
+ * runs unchanged within the group.
+*/
+struct TaskGroups {
+    int n_groups = 1;
+    int group = 0;
+    MPI_Comm comm_all;
+    int rank_all = 0;
+    int size_all = 1;
+};
+
+/**
+ * @brief Decides how many task groups can be formed.
+ * @param n_groups: requested number of groups.
+ * @param scf_inp: scf settings of the displaced calculations.
+ *
+ * The orbital bank serves all work processes, and the exchange operator cannot run
+ * on several processes without it, so in these cases all displacements are computed
+ * by a single group.
+ *
+ * @return Number of groups.
+*/
+int countTaskGroups(int n_groups, const json &scf_inp) {
+    if (n_groups <= 1) return 1;
+    std::string reason;
+#ifdef MRCHEM_HAS_MPI
+    if (mrcpp::mpi::bank_size > 0) reason = "orbital bank is in use";
+    if (scf_inp["fock_operator"].contains("exchange_operator")) reason = "exact exchange requires the orbital bank";
+#else
+    reason = "MPI is not available";
+#endif
+    if (not reason.empty()) {
+        MSG_WARN("Displaced geometries are computed by a single group: " + reason);
+        return 1;
+    }
+    return std::min(n_groups, mrcpp::mpi::wrk_size);
+}
+
+/**
+ * @brief Splits the work communicator into contiguous blocks of processes, one per group.
+*/
+void enterTaskGroup(TaskGroups &groups) {
+    groups.comm_all = mrcpp::mpi::comm_wrk;
+    groups.rank_all = mrcpp::mpi::wrk_rank;
+    groups.size_all = mrcpp::mpi::wrk_size;
+    groups.group = (groups.rank_all * groups.n_groups) / groups.size_all;
+    if (groups.n_groups == 1) return;
+#ifdef MRCHEM_HAS_MPI
+    MPI_Comm comm_grp;
+    MPI_Comm_split(groups.comm_all, groups.group, groups.rank_all, &comm_grp);
+    mrcpp::mpi::comm_wrk = comm_grp;
+    MPI_Comm_rank(comm_grp, &mrcpp::mpi::wrk_rank);
+    MPI_Comm_size(comm_grp, &mrcpp::mpi::wrk_size);
+#endif
+}
+
+/**
+ * @brief Restores the work communicator of all work processes.
+*/
+void leaveTaskGroup(TaskGroups &groups) {
+    if (groups.n_groups == 1) return;
+#ifdef MRCHEM_HAS_MPI
+    MPI_Comm_free(&mrcpp::mpi::comm_wrk);
+    mrcpp::mpi::comm_wrk = groups.comm_all;
+    mrcpp::mpi::wrk_rank = groups.rank_all;
+    mrcpp::mpi::wrk_size = groups.size_all;
+#endif
+    mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
+}
+
+/**
+ * @brief Basis of the internal coordinates in mass-weighted Cartesian space.
+ * @param pos: positions, shape (3, num_atoms).
+ * @param masses: nuclear masses.
+ *
+ * Translations and rotations about the center of mass are projected out. Linear
+ * molecules have one rotation less, which shows up as a rank deficiency.
+ *
+ * @return Orthonormal basis of shape (3 * num_atoms, num_modes).
+*/
+Eigen::MatrixXd internalCoordinates(const Eigen::MatrixXd &pos, const Eigen::VectorXd &masses) {
+    int num_atoms = pos.cols();
+    int n = 3 * num_atoms;
+    Eigen::Vector3d com = pos * masses / masses.sum();
+
+    Eigen::MatrixXd D = Eigen::MatrixXd::Zero(n, 6);
+    for (int i = 0; i < num_atoms; i++) {
+        double sqrt_m = std::sqrt(masses(i));
+        Eigen::Vector3d r = pos.col(i) - com;
+        for (int d = 0; d < 3; d++) {
+            D(3 * i + d, d) = sqrt_m;
+            // rotation about the axis d
+            Eigen::Vector3d e = Eigen::Vector3d::Unit(d);
+            Eigen::Vector3d t = e.cross(r);
+            for (int j = 0; j < 3; j++) D(3 * i + j, 3 + d) = sqrt_m * t(j);
+        }
+    }
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(D);
+    qr.setThreshold(1.0e-6);
+    int rank = qr.rank();
+    Eigen::MatrixXd Q = qr.householderQ();
+    return Q.rightCols(n - rank);
+}
+
+/**
+ * @brief Computes the nuclear Hessian by central differences of analytic gradients,
+ *        and the harmonic frequencies and normal modes.
+ *
+ * @param scf_inp: scf settings.
+ * @param mol_inp: json that contains the molecule at the reference geometry.
+ * @param hess_inp: json that contains the Hessian settings.
+ *
+ * The reference SCF runs on all processes. The work processes are then split into
+ * independent groups, and the 6N displaced geometries are distributed round-robin
+ * over the groups. Every displaced SCF starts from the reference orbitals, carried
+ * along with the displaced nuclei, at the final precision.
+ *
+ * @return Results of the reference calculation together with the vibrational analysis.
+*/
+json hessian_frequencies(json scf_inp, const json &mol_inp, const json &hess_inp) {
+    mrcpp::Timer t_tot;
+    int pprec = 2 * mrcpp::Printer::getPrecision();
+    double h = hess_inp["step_size"];
+    int n_groups = hess_inp["n_groups"];
+    std::string file_phi_ref = hess_inp["file_phi_ref"];
+
+    Molecule mol;
+    driver::init_molecule(mol_inp, mol);
+    int num_atoms = mol.getNNuclei();
+    int n = 3 * num_atoms;
+
+    Eigen::VectorXd masses(num_atoms);
+    for (int i = 0; i < num_atoms; i++) masses(i) = mol.getNuclei()[i].getElement().getMass() * PhysicalConstants::get("amu2au");
+    Eigen::MatrixXd pos = getPositions(mol_inp);
+
+    mrcpp::print::header(0, "Computing the nuclear Hessian by finite differences", 1, '=');
+    print_utils::scalar(0, "Displacements", 2 * n, "", 0);
+    print_utils::scalar(0, "Step size", h, "Bohr", 5, true);
+    mrcpp::print::separator(0, '=', 2);
+
+    // Reference calculation
+    PreviousStep ref;
+    auto ref_results = getSCFResults(mol_inp, scf_inp, &ref);
+    json ref_out = std::get<1>(ref_results);
+    if (not ref_out["success"]) MSG_ABORT("Reference SCF did not converge");
+
+    // Displaced calculations only need the gradient
+    json scf_disp = scf_inp;
+    scf_disp.erase("write_orbitals");
+    scf_disp.erase("write_orbitals_txt");
+    scf_disp.erase("write_operators");
+    scf_disp.erase("plots");
+    // the displaced geometries must not overwrite the checkpoint of the reference
+    if (scf_disp.contains("scf_solver")) scf_disp["scf_solver"]["checkpoint"] = false;
+
+    TaskGroups groups;
+    groups.n_groups = countTaskGroups(n_groups, scf_disp);
+    if (groups.n_groups > 1) {
+        // shared memory blocks span all processes on a node, not only those of a group
+        for (auto &op : scf_disp["fock_operator"]) {
+            if (op.is_object() and op.contains("shared_memory")) op["shared_memory"] = false;
+        }
+        // orbitals are distributed differently within the groups
+        orbital::save_orbitals(ref.Phi, file_phi_ref);
+        mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
+    }
+    print_utils::scalar(0, "Task groups", groups.n_groups, "", 0);
+
+    enterTaskGroup(groups);
+    if (groups.n_groups > 1) ref.Phi = orbital::load_orbitals(file_phi_ref);
+
+    // Column 2k (2k + 1) holds the gradient at the positive (negative) displacement of coordinate k
+    Eigen::MatrixXd grad = Eigen::MatrixXd::Zero(n, 2 * n);
+    Eigen::VectorXd converged = Eigen::VectorXd::Zero(2 * n);
+    Eigen::MatrixXd forces(3, num_atoms);
+    for (int task = groups.group; task < 2 * n; task += groups.n_groups) {
+        int k = task / 2;
+        double sign = (task % 2 == 0) ? 1.0 : -1.0;
+        Eigen::MatrixXd pos_disp = pos;
+        pos_disp(k % 3, k / 3) += sign * h;
+        json mol_disp = mol_inp;
+        setPositions(mol_disp, pos_disp);
+
+        // follow_nuclei refines the orbitals it is given, so each task gets its own copy
+        PreviousStep prev;
+        prev.nucs = ref.nucs;
+        prev.Phi = orbital::deep_copy(ref.Phi);
+        auto results = getSCFResults(mol_disp, scf_disp, &prev);
+        if (mrcpp::mpi::wrk_rank != 0) continue;
+        if (not std::get<1>(results)["success"]) continue;
+        extractForcesInPlace(std::get<0>(results), forces);
+        for (int i = 0; i < num_atoms; i++) {
+            for (int d = 0; d < 3; d++) grad(3 * i + d, task) = -forces(d, i);
+        }
+        converged(task) = 1.0;
+    }
+    ref.Phi.clear();
+    leaveTaskGroup(groups);
+    mrcpp::mpi::allreduce_matrix(grad, mrcpp::mpi::comm_wrk);
+    mrcpp::mpi::allreduce_vector(converged, mrcpp::mpi::comm_wrk);
+    bool success = (converged.sum() > 2.0 * n - 0.5);
+    if (not success) MSG_WARN("Displaced SCF did not converge, Hessian is unreliable");
+
+    Eigen::MatrixXd hessian(n, n);
+    for (int k = 0; k < n; k++) hessian.col(k) = (grad.col(2 * k) - grad.col(2 * k + 1)) / (2.0 * h);
+    hessian = 0.5 * (hessian + hessian.transpose()).eval();
+
+    // Harmonic analysis in mass-weighted coordinates, with translations and rotations removed
+    Eigen::VectorXd m_12(n);
+    for (int i = 0; i < num_atoms; i++) m_12.segment<3>(3 * i).setConstant(1.0 / std::sqrt(masses(i)));
+    Eigen::MatrixXd hess_mw = m_12.asDiagonal() * hessian * m_12.asDiagonal();
+    Eigen::MatrixXd Q = internalCoordinates(pos, masses);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> es(Q.transpose() * hess_mw * Q);
+
+    int n_modes = Q.cols();
+    Eigen::VectorXd freqs(n_modes);
+    Eigen::MatrixXd modes = m_12.asDiagonal() * Q * es.eigenvectors();
+    for (int j = 0; j < n_modes; j++) {
+        // imaginary frequencies are reported as negative numbers
+        double lambda = es.eigenvalues()(j);
+        double omega = std::copysign(std::sqrt(std::abs(lambda)), lambda);
+        freqs(j) = omega * PhysicalConstants::get("hartree2wavenumbers");
+        modes.col(j).normalize();
+    }
+
+    mrcpp::print::header(0, "Harmonic vibrational frequencies", 0, '=');
+    for (int j = 0; j < n_modes; j++) print_utils::scalar(0, "Mode " + std::to_string(j + 1), freqs(j), "cm-1", pprec);
+    mrcpp::print::footer(0, t_tot, 2);
+
+    json vib_out;
+    vib_out["step_size"] = h;
+    vib_out["n_groups"] = groups.n_groups;
+    vib_out["success"] = success;
+    vib_out["hessian"] = std::vector<double>(hessian.data(), hessian.data() + n * n);
+    vib_out["frequencies"] = std::vector<double>(freqs.data(), freqs.data() + n_modes);
+    vib_out["normal_modes"] = json::array();
+    for (int j = 0; j < n_modes; j++) vib_out["normal_modes"].push_back(std::vector<double>(modes.col(j).data(), modes.col(j).data() + n));
+
+    json json_out;
+    json_out["schema_name"] = "mrchem_output";
+    json_out["schema_version"] = 1;
+    json_out["scf_calculation"] = ref_out;
+    json_out["rsp_calculations"] = {};
+    json_out["properties"] = std::get<0>(ref_results);
+    json_out["vibrations"] = vib_out;
+    json_out["success"] = detail::all_success(json_out) and success;
+    return json_out;
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <string>
 #include<tuple>
@@ -14,6 +16,9 @@
 
 #include "chemistry/Molecule.h"
 #include "chemistry/PhysicalConstants.h"
+#include "initial_guess/mw.h"
+#include "qmfunctions/Orbital.h"
+#include "qmfunctions/orbital_utils.h"
 #include "vc_sqnm/periodic_optimizer.hpp"
 
 #include <Eigen/Dense>
@@ -80,21 +85,50 @@ void setPositions(json &mol_inp, const Eigen::MatrixXd &pos) {
     }
 }
 
+/**
+ * @brief Converged orbitals of the previous geometry step, and the nuclei they belong to.
+*/
+struct PreviousStep {
+    Nuclei nucs;
+    OrbitalVector Phi;
+};
+
 /**
  * @brief Does an scf calculation of a molecule.
  * 
  * @param mol_inp: json that describes the molecule.
  * @param scf_inp: scf settings.
+ * @param prev: orbitals of the previous step. If present they are carried along with
+ *              the nuclei and used as initial guess, and the SCF starts at its final precision.
+ *              On return they are replaced by the converged orbitals of this step.
  * 
  * @return: tuple containing print_properties of scf results the json that the driver returned
 */
-std::tuple<json, json> getSCFResults(const json mol_inp, const json scf_inp) {
+std::tuple<json, json> getSCFResults(const json mol_inp, const json scf_inp, PreviousStep *prev = nullptr) {
     Molecule mol;
     std::tuple <json, json> results;
     driver::init_molecule(mol_inp, mol);
-    json scf_out = driver::scf::run(scf_inp, mol);
+
+    json scf_step = scf_inp;
+    if (prev != nullptr and prev->Phi.size() > 0 and scf_inp.contains("scf_solver")) {
+        double prec = scf_inp["scf_solver"]["final_prec"];
+        auto &Phi = mol.getOrbitals();
+        Phi = prev->Phi;
+        if (initial_guess::mw::follow_nuclei(Phi, prec, prev->nucs, mol.getNuclei())) {
+            scf_step["initial_guess"]["type"] = "none";
+            scf_step["scf_solver"]["start_prec"] = prec;
+        } else {
+            Phi.clear();
+        }
+    }
+    json scf_out = driver::scf::run(scf_step, mol);
     // keeping the mpi barrier to be on the safe side, but not sure if it is needed
     mrcpp::mpi::barrier(mrcpp::mpi::comm_wrk);
+    if (prev != nullptr) {
+        prev->nucs = mol.getNuclei();
+        prev->Phi.clear();
+        if (scf_out["success"]) prev->Phi = orbital::deep_copy(mol.getOrbitals());
+    }
     results = std::make_tuple(driver::print_properties(mol), scf_out);
     return results;
 }
@@ -184,7 +218,11 @@ json optimize_positions(json scf_inp, json mol_inp, const json &geopt_inp, std::
     Eigen::MatrixXd forces(3, num_atoms);
     double energy;
     
-    std::tuple<json, json> results_tuple = getSCFResults(mol_inp, scf_inp);
+    // Converged orbitals are carried over to the next geometry step
+    PreviousStep prev_step;
+    PreviousStep *prev = (geopt_inp["use_previous_guess"]) ? &prev_step : nullptr;
+
+    std::tuple<json, json> results_tuple = getSCFResults(mol_inp, scf_inp, prev);
     json results = std::get<0>(results_tuple);
     energy = extractEnergy(results);
 
@@ -215,13 +253,7 @@ json optimize_positions(json scf_inp, json mol_inp, const json &geopt_inp, std::
     while (i < max_iter && forces.cwiseAbs().maxCoeff() > max_force_component) {
         optimizer.step(pos, energy, forces);
         setPositions(mol_inp, pos);
-        if (geopt_inp["use_previous_guess"]) {
-            scf_inp["initial_guess"]["type"] = "mw";
-            scf_inp["initial_guess"]["file_phi_p"] = scf_inp["write_orbitals"]["file_phi_p"];
-            scf_inp["initial_guess"]["file_phi_a"] = scf_inp["write_orbitals"]["file_phi_a"];
-            scf_inp["initial_guess"]["file_phi_b"] = scf_inp["write_orbitals"]["file_phi_b"];
-        }
-        std::tuple<json, json> results_tuple = getSCFResults(mol_inp, scf_inp);
+        std::tuple<json, json> results_tuple = getSCFResults(mol_inp, scf_inp, prev);
         json results = std::get<0>(results_tuple);
         energy = extractEnergy(results);
         extractForcesInPlace(results, forces);
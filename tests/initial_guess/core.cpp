@@ -0,0 +1,109 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include "catch2/catch_all.hpp"
+
+#include "MRCPP/MWOperators"
+
+#include "mrchem.h"
+
+#include "chemistry/Nucleus.h"
+#include "initial_guess/core.h"
+#include "qmfunctions/Orbital.h"
+#include "qmfunctions/orbital_utils.h"
+#include "qmoperators/one_electron/MomentumOperator.h"
+#include "qmoperators/one_electron/NuclearOperator.h"
+#include "qmoperators/qmoperator_utils.h"
+
+using namespace mrchem;
+
+namespace initial_guess_core {
+
+TEST_CASE("Fragment Hamiltonian", "[initial_guess_core]") {
+    const double prec = 1.0e-3;
+    const double thrs = 1.0e-6;
+
+    // two atoms close enough for their AOs to overlap, but not bonded
+    Nuclei nucs;
+    nucs.push_back("H", {-1.5, 0.0, 0.0});
+    nucs.push_back("He", {1.5, 0.0, 0.0});
+
+    auto frags = initial_guess::core::partition_fragments(nucs);
+    REQUIRE(frags.size() == 2);
+
+    OrbitalVector Psi;
+    std::vector<int> frag_sizes;
+    for (const auto &nucs_f : frags) {
+        auto n_ao = Psi.size();
+        initial_guess::core::project_ao(Psi, prec, nucs_f, 2);
+        frag_sizes.push_back(Psi.size() - n_ao);
+    }
+    DoubleVector norms = orbital::get_norms(Psi);
+
+    auto D_p = std::make_shared<mrcpp::ABGVOperator<3>>(*MRA, 0.5, 0.5);
+    MomentumOperator p(D_p);
+    NuclearOperator V(nucs, prec);
+    p.setup(prec);
+    V.setup(prec);
+
+    ComplexMatrix S = orbital::calc_overlap_matrix(Psi);
+    ComplexMatrix F = qmoperator::calc_kinetic_matrix(p, Psi, Psi) + V(Psi, Psi);
+    ComplexMatrix U_full = initial_guess::core::diagonalize(Psi, p, V);
+    ComplexMatrix F_full = U_full.adjoint() * F * U_full;
+
+    SECTION("coupled fragments") {
+        ComplexMatrix U_frag = initial_guess::core::diagonalize_fragments(Psi, p, V, frags, frag_sizes, 12.0);
+        DoubleVector norms_after = orbital::get_norms(Psi);
+        for (int i = 0; i < Psi.size(); i++) {
+            REQUIRE(Psi[i].getRank() == i);
+            REQUIRE(norms_after(i) == Catch::Approx(norms(i)));
+        }
+
+        ComplexMatrix S_frag = U_frag.adjoint() * S * U_frag;
+        ComplexMatrix F_frag = U_frag.adjoint() * F * U_frag;
+        for (int i = 0; i < Psi.size(); i++) {
+            REQUIRE(F_frag(i, i).real() == Catch::Approx(F_full(i, i).real()).margin(thrs));
+            for (int j = 0; j < Psi.size(); j++) {
+                double delta_ij = (i == j) ? 1.0 : 0.0;
+                REQUIRE(std::abs(S_frag(i, j) - delta_ij) < thrs);
+            }
+        }
+    }
+    SECTION("uncoupled fragments") {
+        // the overlap between the fragments is significant at this distance
+        ComplexMatrix U_frag = initial_guess::core::diagonalize_fragments(Psi, p, V, frags, frag_sizes, 1.0);
+        ComplexMatrix S_frag = U_frag.adjoint() * S * U_frag;
+        double max_offdiag = 0.0;
+        for (int i = 0; i < Psi.size(); i++) {
+            REQUIRE(S_frag(i, i).real() == Catch::Approx(1.0).margin(thrs));
+            for (int j = 0; j < i; j++) max_offdiag = std::max(max_offdiag, std::abs(S_frag(i, j)));
+        }
+        REQUIRE(max_offdiag > 0.01);
+    }
+    V.clear();
+    p.clear();
+}
+
+} // namespace initial_guess_core
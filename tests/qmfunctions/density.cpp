@@ -28,8 +28,10 @@
 #include "analyticfunctions/HydrogenFunction.h"
 #include "mrchem.h"
 #include "qmfunctions/Density.h"
+#include "qmfunctions/DensityCache.h"
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/density_utils.h"
+#include "qmfunctions/orbital_utils.h"
 
 using namespace mrchem;
 
@@ -78,6 +80,54 @@ TEST_CASE("Density", "[density]") {
             REQUIRE(rho_a.integrate().real() == Catch::Approx(5.0));
             REQUIRE(rho_b.integrate().real() == Catch::Approx(2.0));
         }
+
+        SECTION("fused density kernel") {
+            // the fused kernel is not used in numerically exact runs, which is the default in the tests
+            OrbitalVector X = orbital::deep_copy(Phi);
+            OrbitalVector Y = orbital::deep_copy(Phi);
+            std::vector<Density> rho_ref, rho_fus;
+            for (auto exact : {true, false}) {
+                mrcpp::mpi::numerically_exact = exact;
+                auto &rho_vec = (exact) ? rho_ref : rho_fus;
+                rho_vec.push_back(Density(false));
+                density::compute_local(prec, rho_vec.back(), Phi, DensityType::Total);
+                rho_vec.push_back(Density(false));
+                density::compute_local(prec, rho_vec.back(), Phi, X, X, DensityType::Total);
+                rho_vec.push_back(Density(false));
+                density::compute_local(prec, rho_vec.back(), Phi, X, Y, DensityType::Total);
+            }
+            mrcpp::mpi::numerically_exact = true;
+
+            REQUIRE(rho_fus[0].integrate().real() == Catch::Approx(7.0));
+            REQUIRE(rho_fus[1].integrate().real() == Catch::Approx(14.0));
+            REQUIRE(rho_fus[2].integrate().real() == Catch::Approx(14.0));
+            for (int i = 0; i < 3; i++) {
+                Density rho_diff(false);
+                mrcpp::add(rho_diff, 1.0, rho_fus[i], -1.0, rho_ref[i], -1.0);
+                REQUIRE(rho_diff.norm() < prec * rho_ref[i].norm());
+            }
+        }
+
+        SECTION("cached density") {
+            DensityCache cache;
+            int version = cache.getVersion();
+
+            Density rho_1 = cache.get(prec, Phi, DensityType::Total);
+            Density rho_2 = cache.get(prec, Phi, DensityType::Total);
+            Density rho_3 = cache.get(10.0 * prec, Phi, DensityType::Total);
+            REQUIRE(cache.size() == 1);
+            REQUIRE(rho_1.integrate().real() == Catch::Approx(7.0));
+            REQUIRE(rho_2.integrate().real() == Catch::Approx(7.0));
+            REQUIRE(rho_3.integrate().real() == Catch::Approx(7.0));
+
+            Density rho_s = cache.get(prec, Phi, DensityType::Spin);
+            REQUIRE(cache.size() == 2);
+            REQUIRE(rho_s.integrate().real() == Catch::Approx(3.0));
+
+            cache.clear();
+            REQUIRE(cache.size() == 0);
+            REQUIRE(cache.getVersion() == version + 1);
+        }
     }
 }
 
@@ -129,4 +129,43 @@ TEST_CASE("CoulombOperator", "[coulomb_operator]") {
     V.clear();
 }
 
+TEST_CASE("CoulombDistributed", "[coulomb_distributed]") {
+    const double prec = 1.0e-3;
+
+    auto Phi_p = std::make_shared<OrbitalVector>();
+    auto P_p = std::make_shared<mrcpp::PoissonOperator>(*MRA, prec);
+
+    OrbitalVector &Phi = *Phi_p;
+    std::vector<std::array<int, 3>> nlm = {{1, 0, 0}, {2, 0, 0}, {2, 1, 0}, {2, 1, 1}, {2, 1, 2}};
+    for (int i = 0; i < nlm.size(); i++) Phi.push_back(Orbital(SPIN::Paired));
+    for (int i = 0; i < Phi.size(); i++) {
+        HydrogenFunction f(nlm[i][0], nlm[i][1], nlm[i][2]);
+        if (mrcpp::mpi::my_func(Phi[i])) mrcpp::project(Phi[i], f, prec);
+    }
+
+    // The split density path is only used in non-exact runs on more than one worker
+    mrcpp::mpi::numerically_exact = false;
+
+    CoulombOperator V_glob(P_p, Phi_p);
+    V_glob.setDistributed(false);
+    V_glob.setup(prec);
+    ComplexMatrix v_glob = V_glob(Phi, Phi);
+    V_glob.clear();
+
+    CoulombOperator V_dist(P_p, Phi_p);
+    V_dist.setDistributed(true);
+    V_dist.setup(prec);
+    ComplexMatrix v_dist = V_dist(Phi, Phi);
+    V_dist.clear();
+
+    mrcpp::mpi::numerically_exact = true;
+
+    for (int i = 0; i < Phi.size(); i++) {
+        for (int j = 0; j < Phi.size(); j++) {
+            REQUIRE(v_dist(i, j).real() == Catch::Approx(v_glob(i, j).real()).margin(10.0 * prec));
+            REQUIRE(std::abs(v_dist(i, j).imag()) < 10.0 * prec);
+        }
+    }
+}
+
 } // namespace coulomb_potential
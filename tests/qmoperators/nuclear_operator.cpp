@@ -30,6 +30,7 @@
 #include "mrchem.h"
 
 #include "analyticfunctions/HydrogenFunction.h"
+#include "analyticfunctions/PointNucleusHFYGB.h"
 #include "chemistry/Nucleus.h"
 #include "qmfunctions/Orbital.h"
 #include "qmfunctions/orbital_utils.h"
@@ -316,4 +317,53 @@ TEST_CASE("PointNucleusMinimum", "[nuclear_operator]") {
     V.clear();
 }
 
+TEST_CASE("NuclearFunction screening", "[nuclear_operator]") {
+    const double prec = 1.0e-6;
+    const double thrs = 1.0e-12;
+
+    // A chain of nuclei, long enough to have several octree levels, and a
+    // compact cluster at its end
+    PeriodicTable pt;
+    PointNucleusHFYGB f;
+    for (int i = 0; i < 20; i++) {
+        Nucleus nuc(pt.getElement("C"), {1.5 * i, 0.3 * (i % 3), 0.0});
+        f.push_back(nuc, f.calcParam1(prec, nuc), f.calcParam2(prec, nuc));
+    }
+    for (int i = 0; i < 64; i++) {
+        Nucleus nuc(pt.getElement("H"), {32.0 + 1.4 * (i % 4), 1.3 * ((i / 4) % 4), 1.5 * (i / 16)});
+        f.push_back(nuc, f.calcParam1(prec, nuc), f.calcParam2(prec, nuc));
+    }
+
+    std::vector<mrcpp::Coord<3>> points;
+    points.push_back({1.0e-3, 0.0, 0.0});   // inside the smoothing region
+    points.push_back({7.6, 0.8, 0.4});      // between nuclei
+    points.push_back({100.0, -50.0, 20.0}); // far away from all nuclei
+    points.push_back({-30.0, 0.0, 0.0});    // far away along the chain
+    points.push_back({33.1, 2.0, 2.2});     // inside the cluster
+    points.push_back({0.0, 40.0, -60.0});   // far away from the cluster
+
+    std::vector<double> ref;
+    for (auto &r : points) ref.push_back(f.evalf(r));
+
+    f.setupScreening();
+    SECTION("evalf") {
+        for (int i = 0; i < points.size(); i++) {
+            REQUIRE(f.evalf(points[i]) == Catch::Approx(ref[i]).epsilon(thrs));
+        }
+    }
+    SECTION("isZeroOnInterval") {
+        double a_0[3] = {-1.0, -1.0, -1.0};
+        double b_0[3] = {1.0, 1.0, 1.0};
+        REQUIRE_FALSE(f.isZeroOnInterval(a_0, b_0));
+
+        double a_1[3] = {-10.0, -10.0, -10.0};
+        double b_1[3] = {-5.0, -5.0, -5.0};
+        REQUIRE(f.isZeroOnInterval(a_1, b_1));
+
+        double a_2[3] = {-100.0, -100.0, -100.0};
+        double b_2[3] = {100.0, 100.0, 100.0};
+        REQUIRE_FALSE(f.isZeroOnInterval(a_2, b_2));
+    }
+}
+
 } // namespace nuclear_potential
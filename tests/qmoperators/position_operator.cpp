@@ -74,6 +74,19 @@ TEST_CASE("PositionOperator", "[position_operator]") {
             for (int j = 0; j < X.cols(); j++) { REQUIRE(std::abs(X(i, j).real() - ref(i, j)) < thrs); }
         }
     }
+    SECTION("moment matrices") {
+        std::vector<DoubleMatrix> R = orbital::calc_moment_matrices(Phi, 2);
+        for (int i = 0; i < nFuncs; i++) {
+            for (int j = 0; j < nFuncs; j++) {
+                REQUIRE(std::abs(R[0](i, j) - ref(i, j)) < thrs);
+                REQUIRE(std::abs(R[1](i, j)) < thrs);
+                REQUIRE(std::abs(R[2](i, j)) < thrs);
+            }
+            // <i|xx|i> = i + 1/2 and <i|yy|i> = 1/2 for harmonic oscillator eigenfunctions
+            REQUIRE(R[3](i, i) == Catch::Approx(i + 0.5).epsilon(prec));
+            REQUIRE(R[6](i, i) == Catch::Approx(0.5).epsilon(prec));
+        }
+    }
     r.clear();
 }
 
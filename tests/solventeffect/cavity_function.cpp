@@ -34,6 +34,7 @@
 #include "mrchem.h"
 
 #include "environment/Cavity.h"
+#include "utils/math_utils.h"
 
 using namespace mrchem;
 
@@ -78,4 +79,44 @@ TEST_CASE("Cavityfunction", "[cavity_function]") {
     double two_sphere_volume = two_cav_tree.integrate();
     REQUIRE(two_sphere_volume == Catch::Approx(7.5096630756284952213).epsilon(thrs * 10));
 }
+
+TEST_CASE("Cavity neighbour screening", "[cavity_function]") {
+    const double thrs = 1.0e-10;
+
+    // row of spheres, far enough apart that the screening removes some of them
+    std::vector<mrcpp::Coord<3>> coords = {{0.0, 0.0, 0.0}, {0.0, 0.0, 1.5}, {0.0, 2.0, 6.0}, {-3.0, 0.0, 12.0}};
+    std::vector<double> R = {1.0, 1.2, 1.0, 1.5};
+    double slope = 0.2;
+    Cavity cavity(coords, R, slope);
+    std::vector<double> W(R.size(), slope);
+
+    std::vector<mrcpp::Coord<3>> points = {{0.1, 0.0, 0.0}, {0.3, -0.4, 0.9}, {0.0, 0.0, 2.7}, {0.5, 1.9, 5.1}, {-2.0, 0.2, 11.0}, {4.0, 4.0, 4.0}};
+
+    SECTION("single point evaluation") {
+        for (auto &r : points) {
+            double ref = 1.0;
+            for (int i = 0; i < coords.size(); i++) ref *= 0.5 * (1.0 + std::erf((math_utils::calc_distance(coords[i], r) - R[i]) / slope));
+            REQUIRE(cavity.evalf(r) == Catch::Approx(1.0 - ref).margin(thrs));
+        }
+    }
+
+    SECTION("block evaluation") {
+        std::vector<double> values;
+        cavity.evalBlock(points, values);
+        REQUIRE(values.size() == points.size());
+        for (int p = 0; p < points.size(); p++) REQUIRE(values[p] == Catch::Approx(cavity.evalf(points[p])).margin(thrs));
+    }
+
+    SECTION("gradient evaluation") {
+        for (int d = 0; d < 3; d++) {
+            std::vector<double> values;
+            cavity.evalGradientBlock(points, d, values);
+            for (int p = 0; p < points.size(); p++) {
+                double ref = detail::gradCavity(points[p], d, coords, R, W);
+                REQUIRE(cavity.evalGradient(points[p], d) == Catch::Approx(ref).margin(1.0e-8));
+                REQUIRE(values[p] == Catch::Approx(cavity.evalGradient(points[p], d)).margin(1.0e-8));
+            }
+        }
+    }
+}
 } // namespace cavity_function
@@ -0,0 +1,78 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include "catch2/catch_all.hpp"
+
+#include <limits>
+#include <random>
+
+#include "surface_forces/SurfaceForce.h"
+
+namespace nearest_neighbour_tests {
+
+Eigen::VectorXd brute_force(const Eigen::MatrixXd &pos) {
+    int n = pos.rows();
+    Eigen::VectorXd dist = Eigen::VectorXd::Constant(n, std::numeric_limits<double>::max());
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j) dist(i) = std::min(dist(i), (pos.row(i) - pos.row(j)).norm());
+        }
+    }
+    return dist;
+}
+
+TEST_CASE("distanceToNearestNeighbour", "[nearest_neighbour]") {
+    SECTION("random points") {
+        int n = 300;
+        Eigen::MatrixXd pos(n, 3);
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<double> dist(-10.0, 10.0);
+        for (int i = 0; i < n; i++) {
+            for (int d = 0; d < 3; d++) pos(i, d) = dist(gen);
+        }
+        Eigen::VectorXd ref = brute_force(pos);
+        Eigen::VectorXd out = surface_force::distanceToNearestNeighbour(pos);
+        for (int i = 0; i < n; i++) REQUIRE(out(i) == Catch::Approx(ref(i)));
+    }
+    SECTION("neighbours across cell faces") {
+        // clusters far apart give large cells, while the nearest neighbours
+        // sit just across the cell faces, closer than any point in the own cell
+        int n = 8;
+        Eigen::MatrixXd pos(n, 3);
+        pos << 0.0, 0.0, 0.0,
+               0.9, 0.0, 0.0,
+               20.0, 0.0, 0.0,
+               10.05, 0.0, 0.0,
+               9.95, 0.0, 0.0,
+               0.0, 20.0, 0.0,
+               0.0, 0.0, 20.0,
+               20.0, 20.0, 20.0;
+        Eigen::VectorXd ref = brute_force(pos);
+        Eigen::VectorXd out = surface_force::distanceToNearestNeighbour(pos);
+        for (int i = 0; i < n; i++) REQUIRE(out(i) == Catch::Approx(ref(i)));
+    }
+}
+
+} // namespace nearest_neighbour_tests
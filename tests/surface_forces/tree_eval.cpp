@@ -0,0 +1,82 @@
+/*
+ * MRChem, a numerical real-space code for molecular electronic structure
+ * calculations within the self-consistent field (SCF) approximations of quantum
+ * chemistry (Hartree-Fock and Density Functional Theory).
+ * Copyright (C) 2023 Stig Rune Jensen, Luca Frediani, Peter Wind and contributors.
+ *
+ * This file is part of MRChem.
+ *
+ * MRChem is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MRChem is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with MRChem.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For information on the complete list of contributors to MRChem, see:
+ * <https://mrchem.readthedocs.io/>
+ */
+
+#include "catch2/catch_all.hpp"
+
+#include <random>
+
+#include "mrchem.h"
+#include "qmfunctions/Orbital.h"
+#include "surface_forces/treeEval.h"
+
+using namespace mrchem;
+
+namespace tree_eval_tests {
+
+std::function<double(const mrcpp::Coord<3> &r)> f1 = [](const mrcpp::Coord<3> &r) -> double {
+    double R = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    return std::exp(-1.0 * R * R);
+};
+
+std::function<double(const mrcpp::Coord<3> &r)> f2 = [](const mrcpp::Coord<3> &r) -> double {
+    double R = std::sqrt((r[0] - 0.5) * (r[0] - 0.5) + r[1] * r[1] + r[2] * r[2]);
+    return r[2] * std::exp(-2.0 * R * R);
+};
+
+TEST_CASE("evalTrees", "[tree_eval]") {
+    const double prec = 1.0e-3;
+    const double thrs = 1.0e-12;
+
+    Orbital phi_1(SPIN::Paired);
+    Orbital phi_2(SPIN::Paired);
+    mrcpp::project(phi_1, f1, prec);
+    mrcpp::project(phi_2, f2, prec);
+
+    // random points, plus some on node boundaries and outside the box
+    int nPoints = 200;
+    Eigen::MatrixXd gridPos(nPoints + 3, 3);
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> dist(-2.0, 2.0);
+    for (int p = 0; p < nPoints; p++) {
+        for (int d = 0; d < 3; d++) gridPos(p, d) = dist(gen);
+    }
+    gridPos.row(nPoints) << 0.0, 0.0, 0.0;
+    gridPos.row(nPoints + 1) << 0.5, -0.25, 0.125;
+    gridPos.row(nPoints + 2) << 100.0, 0.0, 0.0;
+
+    std::vector<const mrcpp::FunctionTree<3> *> trees = {&phi_1.real(), &phi_2.real()};
+    Eigen::MatrixXd values = surface_force::evalTrees(trees, gridPos);
+
+    REQUIRE(values.rows() == gridPos.rows());
+    REQUIRE(values.cols() == 2);
+    for (int f = 0; f < 2; f++) {
+        for (int p = 0; p < gridPos.rows(); p++) {
+            mrcpp::Coord<3> r{gridPos(p, 0), gridPos(p, 1), gridPos(p, 2)};
+            REQUIRE(values(p, f) == Catch::Approx(trees[f]->evalf(r)).margin(thrs));
+        }
+    }
+}
+
+} // namespace tree_eval_tests